@@ -0,0 +1,152 @@
+/**
+ * async.cpp -- compares printing through AsyncLogger with synchronous print(): throughput from several
+ * threads and the latency seen by the printing thread
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+
+namespace ts = termstyle;
+
+#if defined(_WIN32)
+#include <io.h>
+static const char *const null_device = "NUL";
+#else
+static const char *const null_device = "/dev/null";
+#endif
+
+namespace
+{
+    /**
+     * A target that takes a fixed time per write, like a terminal or a pipe that is slow to drain.
+    */
+    class SlowTarget : public ts::OutputTarget
+    {
+    private:
+        ts::OutputTarget &target;
+        std::chrono::nanoseconds cost;
+
+    public:
+        SlowTarget(ts::OutputTarget &target, std::chrono::nanoseconds cost) : target(target), cost(cost) {}
+
+        void write(std::string_view data) override
+        {
+            const auto until = std::chrono::steady_clock::now() + cost;
+            target.write(data);
+            while (std::chrono::steady_clock::now() < until) {}
+        }
+    };
+
+    /**
+     * Prints `lines` lines from each of `threads` threads and returns the lines per second.
+    */
+    template<typename F>
+    double linesPerSecond(int threads, int lines, F &&print)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < lines; i++)
+                {
+                    print(t, i);
+                }
+            });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return threads * lines / seconds;
+    }
+
+    /**
+     * Times each of `count` calls of `print` and prints the percentiles.
+    */
+    template<typename F>
+    void latency(const char *name, int count, F &&print)
+    {
+        std::vector<double> ns(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            print(i);
+            ns[static_cast<std::size_t>(i)] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::sort(ns.begin(), ns.end());
+        auto at = [&](double q) { return ns[static_cast<std::size_t>(q * (count - 1))]; };
+        std::printf("%-40s %10.1f p50 %10.1f p99 %10.1f p99.9 %10.1f max (ns)\n", name, at(0.5), at(0.99), at(0.999), ns.back());
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::PresetConfig error_preset;
+    error_preset.prefix.prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_RED)};
+    error_preset.prefix.text = "[ERROR] ";
+    error_preset.prefix.poststyles = {ts::Color(ts::Codes::BRIGHT_RESET)};
+    ts::PresetHandle error = ts::addPreset("error", error_preset);
+    const std::string text = "An error has occurred while processing your request.";
+
+#if defined(_WIN32)
+    int null_fd = _open(null_device, _O_WRONLY);
+#else
+    int null_fd = open(null_device, O_WRONLY);
+#endif
+    ts::FdTarget null_fd_target(null_fd);
+    bench::MemoryTarget memory_target;
+
+    bench::section("Enqueueing");
+    {
+        ts::AsyncLogger logger(memory_target, 1 << 14);
+        bench::run("AsyncLogger::print(handle)", [&] { logger.print(error, text); return text.size(); });
+        bench::run("AsyncLogger::print(handle, fmt, args)", [&] {
+            logger.print(error, "request {} failed after {}ms", 4711, 12.5);
+            return text.size();
+        });
+    }
+    bench::run("print(handle) -> memory", [&] { ts::print(memory_target, error, text); return text.size(); });
+
+    bench::section("Throughput to /dev/null fd (lines/s)");
+    const int lines = 100000;
+    for (int threads : {1, 2, 4})
+    {
+        const double sync = linesPerSecond(threads, lines, [&](int, int) { ts::print(null_fd_target, error, text); });
+        double async;
+        {
+            ts::AsyncLogger logger(null_fd_target, 1 << 14);
+            async = linesPerSecond(threads, lines, [&](int, int) { logger.print(error, text); });
+            logger.flush();
+        }
+        std::printf("%d thread(s): print() %12.0f, AsyncLogger %12.0f\n", threads, sync, async);
+    }
+
+    bench::section("Latency of one line to a target taking 20us per write");
+    SlowTarget slow(null_fd_target, std::chrono::microseconds(20));
+    const int samples = 20000;
+    latency("print(handle)", samples, [&](int) { ts::print(slow, error, text); });
+    {
+        ts::AsyncLogger logger(slow, 1 << 15);
+        latency("AsyncLogger::print(handle)", samples, [&](int) { logger.print(error, text); });
+    }
+    {
+        ts::AsyncLogger logger(slow, 256, ts::OverflowPolicy::DROP);
+        latency("AsyncLogger::print(handle), DROP", samples, [&](int) { logger.print(error, text); });
+        logger.flush();
+        std::printf("%-40s %10zu lines dropped\n", "", logger.dropped());
+    }
+
+#if defined(_WIN32)
+    _close(null_fd);
+#else
+    close(null_fd);
+#endif
+    return 0;
+}
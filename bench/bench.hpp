@@ -0,0 +1,220 @@
+/**
+ * bench.hpp -- a minimal benchmark harness shared by the benchmarks in this directory
+ *
+ * Each benchmark reports the time per operation, the heap allocations per operation and
+ * the bytes emitted per operation. Include it from exactly one source file per executable,
+ * because it replaces the global allocation functions to count allocations.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include "../include/termstyle.hpp"
+
+namespace bench
+{
+    inline std::atomic<std::size_t> allocations{0};
+
+    /**
+     * Prevents the compiler from discarding a computed value.
+    */
+    inline void keep(std::size_t value)
+    {
+        static volatile std::size_t sink;
+        sink = sink + value;
+    }
+
+    /**
+     * Hides a value from the optimizer, so that work depending on it is not hoisted out of the loop.
+    */
+    template<typename T>
+    const T &opaque(const T &value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+        return value;
+    }
+
+    /**
+     * Runs `op` repeatedly for about `budget` and prints one result line.
+     * `op` returns the number of bytes it emitted. Returns the time per operation in nanoseconds.
+    */
+    template<typename F>
+    double run(std::string_view name, F &&op, std::chrono::milliseconds budget = std::chrono::milliseconds(200))
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            keep(op());
+        }
+
+        std::size_t iterations = 0;
+        std::size_t bytes = 0;
+        std::size_t allocs_before = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + budget;
+        auto now = start;
+        do
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                bytes += op();
+            }
+            iterations += 256;
+            now = std::chrono::steady_clock::now();
+        } while (now < deadline);
+        std::size_t allocs = allocations.load(std::memory_order_relaxed) - allocs_before;
+        keep(bytes);
+
+        double ns = std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(iterations);
+        std::printf("%-40.*s %10.1f ns/op %8.2f allocs/op %8.1f bytes/op\n", static_cast<int>(name.size()), name.data(), ns,
+                    static_cast<double>(allocs) / static_cast<double>(iterations),
+                    static_cast<double>(bytes) / static_cast<double>(iterations));
+        return ns;
+    }
+
+    /**
+     * Prints a section header.
+    */
+    inline void section(const char *title)
+    {
+        std::printf("\n%s\n", title);
+    }
+
+    /**
+     * An output target that keeps output in a reusable buffer, so writing to memory does not allocate once warm.
+    */
+    class MemoryTarget : public termstyle::OutputTarget
+    {
+    public:
+        std::string buffer;
+
+        MemoryTarget()
+        {
+            buffer.reserve(1 << 20);
+        }
+
+        void write(std::string_view data) override
+        {
+            if (buffer.size() + data.size() > buffer.capacity())
+            {
+                buffer.clear();
+            }
+            buffer.append(data);
+        }
+    };
+
+    /**
+     * An output target that counts the bytes passed through it before forwarding them.
+    */
+    class CountingTarget : public termstyle::OutputTarget
+    {
+    private:
+        termstyle::OutputTarget &target;
+
+    public:
+        std::size_t bytes = 0;
+
+        explicit CountingTarget(termstyle::OutputTarget &target) : target(target) {}
+
+        void write(std::string_view data) override
+        {
+            bytes += data.size();
+            target.write(data);
+        }
+
+        void writeLine(std::string_view prefix, std::string_view text, std::string_view suffix) override
+        {
+            bytes += prefix.size() + text.size() + suffix.size();
+            target.writeLine(prefix, text, suffix);
+        }
+
+        void writev(const std::string_view *parts, std::size_t count) override
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                bytes += parts[i].size();
+            }
+            target.writev(parts, count);
+        }
+
+        /**
+         * @return The bytes counted since the last call.
+        */
+        std::size_t take()
+        {
+            std::size_t res = bytes;
+            bytes = 0;
+            return res;
+        }
+    };
+
+    /**
+     * A stream that discards everything inserted into it and counts the bytes.
+    */
+    class CountingStream : private std::streambuf, public std::ostream
+    {
+    private:
+        std::size_t bytes = 0;
+
+        std::streamsize xsputn(const char *, std::streamsize n) override
+        {
+            bytes += static_cast<std::size_t>(n);
+            return n;
+        }
+
+        std::streambuf::int_type overflow(std::streambuf::int_type c) override
+        {
+            bytes++;
+            return std::streambuf::traits_type::not_eof(c);
+        }
+
+    public:
+        CountingStream() : std::ostream(this) {}
+
+        /**
+         * @return The bytes counted since the last call.
+        */
+        std::size_t take()
+        {
+            std::size_t res = bytes;
+            bytes = 0;
+            return res;
+        }
+    };
+} // namespace bench
+
+// Kept out of line so that GCC does not pair the inlined malloc/free with new/delete expressions.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void *operator new(std::size_t size)
+{
+    bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,92 @@
+/**
+ * decode.cpp -- measures the throughput of decoding captured output back into styled runs, whole and in chunks
+*/
+
+#include <chrono>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    /**
+     * Captures `lines` lines printed with a few presets and styled fields into one string.
+     */
+    std::string capture(std::size_t lines, std::size_t width)
+    {
+        ts::RingBufferTarget target(1 << 26);
+        ts::StyledWriter writer(target);
+        const std::string text(width, 'x');
+        for (std::size_t i = 0; i < lines; i++)
+        {
+            writer.print(i % 3 == 0 ? "warn" : "info", text);
+        }
+        writer.flush();
+        return target.contents();
+    }
+
+    struct Totals
+    {
+        std::size_t bytes = 0;
+        std::size_t runs = 0;
+        std::uint32_t attributes = 0;
+    };
+
+    double mbPerSecond(const std::string &input, std::size_t chunk, Totals &totals)
+    {
+        const int repeat = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++)
+        {
+            ts::SgrDecoder decoder;
+            for (std::size_t pos = 0; pos < input.size(); pos += chunk)
+            {
+                decoder.feed(std::string_view(input).substr(pos, chunk), [&totals](std::string_view text, const ts::SgrState &state) {
+                    totals.bytes += text.size();
+                    totals.runs++;
+                    totals.attributes += state.attributes;
+                });
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(input.size()) * repeat / std::chrono::duration<double, std::micro>(end - start).count();
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::addPreset("info", {
+        .prefix = {
+            .text = "[INFO] ",
+            .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 200, 80))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+    ts::addPreset("warn", {
+        .prefix = {
+            .text = "[WARN] ",
+            .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 214))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+
+    const std::pair<const char *, std::string> inputs[] = {
+        {"short lines (24 chars)", capture(1 << 18, 24)},
+        {"long lines (400 chars)", capture(1 << 15, 400)},
+    };
+    for (const auto &input : inputs)
+    {
+        const std::string &str = input.second;
+        const std::size_t visible = ts::strip_styles(str).size();
+        std::cout << input.first << ", " << str.size() / (1 << 20) << " MiB\n";
+        for (std::size_t chunk : {str.size(), std::size_t{65536}, std::size_t{4096}, std::size_t{64}})
+        {
+            Totals totals;
+            const double mbs = mbPerSecond(str, chunk, totals);
+            std::cout << "  chunks of " << (chunk == str.size() ? std::string("all") : std::to_string(chunk)) << ": " << mbs
+                      << " MB/s, " << totals.runs / 5 << " runs" << (totals.bytes == visible * 5 ? "" : " (MISMATCH)") << '\n';
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * export.cpp -- measures the throughput of converting a captured log into HTML and SVG, whole and in chunks
+*/
+
+#include <chrono>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    /**
+     * Captures `lines` lines printed with a few presets into one string.
+     */
+    std::string capture(std::size_t lines, std::size_t width)
+    {
+        ts::RingBufferTarget target(1 << 26);
+        ts::StyledWriter writer(target);
+        const std::string text(width, 'x');
+        for (std::size_t i = 0; i < lines; i++)
+        {
+            writer.print(i % 3 == 0 ? "warn" : "info", text);
+        }
+        writer.flush();
+        return target.contents();
+    }
+
+    /**
+     * Counts the bytes of the document and discards them, like a file on an infinitely fast disk.
+     */
+    class CountingTarget : public ts::OutputTarget
+    {
+    public:
+        std::size_t bytes = 0;
+        std::size_t largest = 0;
+
+        void write(std::string_view data) override
+        {
+            bytes += data.size();
+            largest = std::max(largest, data.size());
+        }
+    };
+
+    double mbPerSecond(const std::string &input, ts::ExportFormat format, std::size_t chunk, CountingTarget &target)
+    {
+        const int repeat = 3;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++)
+        {
+            target.bytes = 0;
+            ts::Exporter exporter(target, format);
+            exporter.namePreset("warn");
+            exporter.namePreset("info");
+            for (std::size_t pos = 0; pos < input.size(); pos += chunk)
+            {
+                exporter.feed(std::string_view(input).substr(pos, chunk));
+            }
+            exporter.finish();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(input.size()) * repeat / std::chrono::duration<double, std::micro>(end - start).count();
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::addPreset("info", {
+        .prefix = {
+            .text = "[INFO] ",
+            .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 200, 80))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+    ts::addPreset("warn", {
+        .prefix = {
+            .text = "[WARN] ",
+            .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 214))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+
+    const std::pair<const char *, std::string> inputs[] = {
+        {"short lines (24 chars)", capture(1 << 18, 24)},
+        {"long lines (400 chars)", capture(1 << 15, 400)},
+    };
+    for (const auto &input : inputs)
+    {
+        const std::string &str = input.second;
+        std::cout << input.first << ", " << str.size() / (1 << 20) << " MiB\n";
+        for (ts::ExportFormat format : {ts::ExportFormat::HTML, ts::ExportFormat::SVG})
+        {
+            for (std::size_t chunk : {str.size(), std::size_t{65536}, std::size_t{4096}})
+            {
+                CountingTarget target;
+                const double mbs = mbPerSecond(str, format, chunk, target);
+                std::cout << "  " << (format == ts::ExportFormat::HTML ? "HTML" : "SVG ") << " in chunks of "
+                          << (chunk == str.size() ? std::string("all") : std::to_string(chunk)) << ": " << mbs << " MB/s, "
+                          << target.bytes / (1 << 20) << " MiB written in blocks of at most " << target.largest / 1024 << " KiB\n";
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * gradient.cpp -- measures glyphs per second of 200-column gradient bars against styling every glyph separately
+*/
+
+#include "bench.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    constexpr std::size_t columns = 200;
+
+    void glyphsPerSecond(std::string_view name, double ns)
+    {
+        std::printf("%-40.*s %10.1f Mglyphs/s\n", static_cast<int>(name.size()), name.data(), columns * 1e3 / ns);
+    }
+
+    ts::ColRGB lerp(const ts::ColRGB &from, const ts::ColRGB &to, std::size_t cell)
+    {
+        auto mix = [cell](int a, int b) { return a + (b - a) * static_cast<int>(cell) / static_cast<int>(columns - 1); };
+        return ts::ColRGB(from.mode, mix(from.r, to.r), mix(from.g, to.g), mix(from.b, to.b));
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    const ts::ColRGB from(ts::ColorMode::BACKGROUND, 0, 0, 255), to(ts::ColorMode::BACKGROUND, 255, 0, 0);
+    const ts::Gradient heat{from, ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 255, 0), to};
+    std::string bar;
+    for (std::size_t i = 0; i < columns; i++) bar += "█";
+    const std::string spaces(columns, ' ');
+    std::string out;
+
+    bench::section("200-column bar, one styled glyph at a time");
+    glyphsPerSecond("PresetConfig + parse() per glyph", bench::run("PresetConfig + parse() per glyph", [&] {
+        out.clear();
+        for (std::size_t i = 0; i < columns; i++)
+        {
+            ts::PresetConfig config;
+            config.prefix.prestyles = {ts::Color(lerp(from, to, i))};
+            config.prefix.text = "█";
+            out += ts::parse(config);
+        }
+        return out.size();
+    }));
+    glyphsPerSecond("append_to(ColRGB) per glyph", bench::run("append_to(ColRGB) per glyph", [&] {
+        out.clear();
+        for (std::size_t i = 0; i < columns; i++)
+        {
+            ts::append_to(out, lerp(from, to, i));
+            out += "█";
+        }
+        out += "\033[49m";
+        return out.size();
+    }));
+
+    bench::section("200-column bar, Gradient");
+    bench::run("Gradient construction (3 stops)", [&] {
+        ts::Gradient gradient{from, ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 255, 0), to};
+        return static_cast<std::size_t>(gradient.at(0, 1).b);
+    });
+    const std::pair<const char *, ts::ColorSupport> supports[] = {
+        {"append_to(Gradient, bar) COLRGB", ts::ColorSupport::COLRGB},
+        {"append_to(Gradient, bar) COL256", ts::ColorSupport::COL256},
+        {"append_to(Gradient, bar) COL16", ts::ColorSupport::COL16},
+    };
+    for (const auto &support : supports)
+    {
+        ts::setColorSupport(support.second);
+        glyphsPerSecond(support.first, bench::run(support.first, [&] {
+            out.clear();
+            ts::append_to(out, heat, bar);
+            return out.size();
+        }));
+    }
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    glyphsPerSecond("append_to(Gradient, spaces) COLRGB", bench::run("append_to(Gradient, spaces) COLRGB", [&] {
+        out.clear();
+        ts::append_to(out, heat, spaces);
+        return out.size();
+    }));
+    char buffer[8192];
+    glyphsPerSecond("render_to(Gradient, bar) COLRGB", bench::run("render_to(Gradient, bar) COLRGB", [&] {
+        return ts::render_to(buffer, sizeof(buffer), heat, bar);
+    }));
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * quantize.cpp -- compares the table-driven RGB quantizers against a naive palette search
+*/
+
+#include <chrono>
+#include <random>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    int naive256(const ts::ColRGB &col)
+    {
+        int best = 16;
+        int best_distance = 3 * 256 * 256;
+        for (int id = 16; id < 256; id++)
+        {
+            ts::ColRGB p = ts::toColRGB(ts::Col256(ts::ColorMode::FOREGROUND, id));
+            int d = (col.r - p.r) * (col.r - p.r) + (col.g - p.g) * (col.g - p.g) + (col.b - p.b) * (col.b - p.b);
+            if (d < best_distance)
+            {
+                best = id;
+                best_distance = d;
+            }
+        }
+        return best;
+    }
+
+    ts::Codes naive16(const ts::ColRGB &col)
+    {
+        int best = 0;
+        int best_distance = 3 * 256 * 256;
+        for (int id = 0; id < 16; id++)
+        {
+            ts::ColRGB p = ts::toColRGB(ts::Col256(ts::ColorMode::FOREGROUND, id));
+            int d = (col.r - p.r) * (col.r - p.r) + (col.g - p.g) * (col.g - p.g) + (col.b - p.b) * (col.b - p.b);
+            if (d < best_distance)
+            {
+                best = id;
+                best_distance = d;
+            }
+        }
+        return static_cast<ts::Codes>(30 + best % 8);
+    }
+
+    template<typename F>
+    double nsPerColor(std::size_t count, F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+    }
+}
+
+int main()
+{
+    const std::size_t count = 1 << 20;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> channel(0, 255);
+    std::vector<ts::ColRGB> colors;
+    colors.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        colors.emplace_back(ts::ColorMode::FOREGROUND, channel(rng), channel(rng), channel(rng));
+    }
+
+    std::vector<std::uint8_t> ids(count), naive_ids(count);
+    std::vector<ts::Codes> codes(count, ts::Codes::RESTORE), naive_codes(count, ts::Codes::RESTORE);
+
+    double naive256_ns = nsPerColor(count, [&] {
+        for (std::size_t i = 0; i < count; i++) naive_ids[i] = static_cast<std::uint8_t>(naive256(colors[i]));
+    });
+    double bulk256_ns = nsPerColor(count, [&] { ts::toCol256(colors.data(), count, ids.data()); });
+    double naive16_ns = nsPerColor(count, [&] {
+        for (std::size_t i = 0; i < count; i++) naive_codes[i] = naive16(colors[i]);
+    });
+    double bulk16_ns = nsPerColor(count, [&] { ts::toCodes(colors.data(), count, codes.data()); });
+
+    std::size_t mismatch256 = 0, mismatch16 = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        mismatch256 += ids[i] != naive_ids[i];
+        mismatch16 += codes[i] != naive_codes[i];
+    }
+
+    std::cout << "RGB -> 256  naive: " << naive256_ns << " ns/color, bulk: " << bulk256_ns << " ns/color ("
+              << naive256_ns / bulk256_ns << "x), " << mismatch256 << " ties resolved differently\n";
+    std::cout << "RGB -> 16   naive: " << naive16_ns << " ns/color, bulk: " << bulk16_ns << " ns/color ("
+              << naive16_ns / bulk16_ns << "x), " << mismatch16 << " ties resolved differently\n";
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * render.cpp -- benchmarks the rendering functions and the print paths
+*/
+
+#include <fcntl.h>
+#include <fstream>
+#include "bench.hpp"
+
+namespace ts = termstyle;
+
+#if defined(_WIN32)
+#include <io.h>
+static const char *const null_device = "NUL";
+#else
+static const char *const null_device = "/dev/null";
+#endif
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    const ts::Col256 col256(ts::ColorMode::FOREGROUND, 208);
+    const ts::ColRGB colrgb(ts::ColorMode::BACKGROUND, 30, 144, 255);
+    const std::vector<ts::Codes> codelist = {ts::Codes::BRIGHT, ts::Codes::UNDERLINE, ts::Codes::FOREGROUND_RED};
+    const std::vector<ts::Col256> col256list = {col256, ts::Col256(ts::ColorMode::BACKGROUND, 17)};
+    const std::vector<ts::Color> colorlist = {ts::Color(ts::Codes::BRIGHT), ts::Color(col256), ts::Color(colrgb)};
+
+    ts::PresetConfig error_preset;
+    error_preset.prefix.prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_RED)};
+    error_preset.prefix.text = "[ERROR] ";
+    error_preset.prefix.poststyles = {ts::Color(ts::Codes::BRIGHT_RESET)};
+    ts::PresetHandle error = ts::addPreset("error", error_preset);
+    const ts::PresetConfig &config = ts::presets["error"];
+    ts::PresetConfig merged_config = config;
+    merged_config.config.merge_sequences = true;
+
+    const std::string text = "An error has occurred while processing your request.";
+
+    bench::section("Rendering");
+    bench::run("code2string(Codes)", [&] { return ts::code2string(bench::opaque(ts::Codes::FOREGROUND_RED)).size(); });
+    bench::run("code2string(vector<Codes>)", [&] { return ts::code2string(codelist).size(); });
+    bench::run("col256_2string(Col256)", [&] { return ts::col256_2string(col256).size(); });
+    bench::run("col256_2string(vector<Col256>)", [&] { return ts::col256_2string(col256list).size(); });
+    bench::run("colrgb_2string(ColRGB)", [&] { return ts::colrgb_2string(colrgb).size(); });
+    bench::run("parseColortype(vector<Color>)", [&] { return ts::parseColortype(colorlist).size(); });
+    bench::run("parse(ParseMode::ALL)", [&] { return ts::parse(config, ts::ParseMode::ALL).size(); });
+    bench::run("parse(ParseMode::PREFIX)", [&] { return ts::parse(config, ts::ParseMode::PREFIX).size(); });
+    bench::run("parse(ParseMode::SUFFIX)", [&] { return ts::parse(config, ts::ParseMode::SUFFIX).size(); });
+    bench::run("parse(ParseMode::ALL), merged", [&] { return ts::parse(merged_config, ts::ParseMode::ALL).size(); });
+
+    bench::section("Rendering into buffers");
+    char buffer[256];
+    std::string appended;
+    appended.reserve(256);
+    bench::run("render_to(char*, vector<Color>)", [&] { return ts::render_to(buffer, sizeof(buffer), colorlist); });
+    bench::run("render_to(char*, PresetConfig, ALL)", [&] {
+        return ts::render_to(buffer, sizeof(buffer), config, ts::ParseMode::ALL);
+    });
+    bench::run("append_to(string&, PresetConfig, ALL)", [&] {
+        appended.clear();
+        ts::append_to(appended, config, ts::ParseMode::ALL);
+        return appended.size();
+    });
+
+    bench::section("Presets");
+    bench::run("copy PresetConfig", [&] {
+        ts::PresetConfig copy = bench::opaque(config);
+        return copy.prefix.prestyles.size();
+    });
+    bench::run("compilePreset(PresetConfig)", [&] { return ts::compilePreset(config).prefix.size(); });
+
+#if defined(_WIN32)
+    int null_fd = _open(null_device, _O_WRONLY);
+#else
+    int null_fd = open(null_device, O_WRONLY);
+#endif
+    ts::FdTarget null_fd_target(null_fd);
+    std::ofstream null_stream(null_device);
+    ts::StreamTarget null_stream_target(null_stream);
+    bench::MemoryTarget memory_target;
+
+    bench::CountingTarget to_fd(null_fd_target);
+    bench::CountingTarget to_stream(null_stream_target);
+    bench::CountingTarget to_memory(memory_target);
+
+    bench::section("print()");
+    bench::run("print(name) -> /dev/null fd", [&] { ts::print(to_fd, "error", text); return to_fd.take(); });
+    bench::run("print(handle) -> /dev/null fd", [&] { ts::print(to_fd, error, text); return to_fd.take(); });
+    const std::string payload(16 * 1024, 'x');
+    bench::run("print(handle, 16 KiB) -> /dev/null fd", [&] { ts::print(to_fd, error, payload); return to_fd.take(); });
+    bench::run("print(handle) -> /dev/null ofstream", [&] { ts::print(to_stream, error, text); return to_stream.take(); });
+    bench::run("print(name) -> memory", [&] { ts::print(to_memory, "error", text); return to_memory.take(); });
+    bench::run("print(handle) -> memory", [&] { ts::print(to_memory, error, text); return to_memory.take(); });
+
+    bench::section("Printing 200 lines");
+    std::vector<std::string> table;
+    for (int i = 0; i < 200; i++)
+    {
+        table.push_back("row " + std::to_string(i) + " | " + text);
+    }
+    bench::run("print(handle) x200 -> /dev/null fd", [&] {
+        for (const std::string &row : table)
+        {
+            ts::print(to_fd, error, row);
+        }
+        return to_fd.take();
+    });
+    bench::run("print_lines(handle, 200) -> /dev/null fd", [&] { ts::print_lines(to_fd, error, table); return to_fd.take(); });
+    bench::run("print(handle) x200 -> memory", [&] {
+        for (const std::string &row : table)
+        {
+            ts::print(to_memory, error, row);
+        }
+        return to_memory.take();
+    });
+    bench::run("print_lines(handle, 200) -> memory", [&] { ts::print_lines(to_memory, error, table); return to_memory.take(); });
+
+    bench::section("Formatted print()");
+    const int request_id = 4711;
+    const double elapsed = 12.5;
+    bench::run("print(handle, concatenated) -> memory", [&] {
+        ts::print(to_memory, error, "request " + std::to_string(request_id) + " failed after " + std::to_string(elapsed) + "ms");
+        return to_memory.take();
+    });
+    bench::run("print(handle, fmt, args) -> memory", [&] {
+        ts::print(to_memory, error, "request {} failed after {}ms", request_id, elapsed);
+        return to_memory.take();
+    });
+
+    bench::section("Markup");
+    bench::run("PresetConfig + parse() per fragment", [&] {
+        ts::PresetConfig label, value;
+        label.prefix.prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_RED)};
+        label.prefix.text = "ERROR";
+        label.prefix.poststyles = {ts::Color(ts::Codes::RESTORE)};
+        value.prefix.prestyles = {ts::Color(ts::Codes::FOREGROUND_CYAN)};
+        value.prefix.text = std::to_string(request_id) + "ms";
+        value.prefix.poststyles = {ts::Color(ts::Codes::RESTORE)};
+        return (ts::parse(label) + " took " + ts::parse(value)).size();
+    });
+    bench::run("compile markup (uncached)", [&] {
+        ts::detail::CompiledMarkup compiled;
+        ts::detail::compileMarkup(compiled, "[b red]ERROR[/] took [cyan]{}ms[/]", ts::ColorSupport::COLRGB);
+        return compiled.bytes.size();
+    });
+    bench::run("render(markup, args)", [&] { return ts::render("[b red]ERROR[/] took [cyan]{}ms[/]", request_id).size(); });
+    std::string markup_line;
+    bench::run("append_markup(line, markup, args)", [&] {
+        markup_line.clear();
+        ts::append_markup(markup_line, "[b red]ERROR[/] took [cyan]{}ms[/]", request_id);
+        return markup_line.size();
+    });
+    bench::run("print_markup(markup, args) -> memory", [&] {
+        ts::print_markup(to_memory, "[b red]ERROR[/] took [cyan]{}ms[/]\n", request_id);
+        return to_memory.take();
+    });
+
+    bench::section("style()");
+    bench::run("style(handle) -> /dev/null fd", [&] {
+        ts::style(error, to_fd) << text;
+        return to_fd.take();
+    });
+    bench::run("style(handle) -> /dev/null ofstream", [&] {
+        ts::style(error, to_stream) << text;
+        return to_stream.take();
+    });
+    bench::run("style(handle) -> memory", [&] {
+        ts::style(error, to_memory) << text;
+        return to_memory.take();
+    });
+
+    bench::section("Style expressions");
+    constexpr auto alert = ts::fg(ts::Codes::FOREGROUND_RED) | ts::bold | ts::bg(236);
+    bench::CountingStream counting_stream;
+    bench::run("ostream << styled(text, expr)", [&] {
+        counting_stream << ts::styled(text, alert);
+        return counting_stream.take();
+    });
+    bench::run("print(expr, text) -> memory", [&] { ts::print(to_memory, alert, text); return to_memory.take(); });
+
+    bench::section("StyledWriter");
+    {
+        ts::StyledWriter writer(to_memory);
+        bench::run("StyledWriter::print() -> memory", [&] { writer.print(error, text); return to_memory.take(); });
+        writer.setStateTracking(true);
+        bench::run("StyledWriter::print(), tracked -> memory", [&] {
+            writer.print(error, text);
+            return to_memory.take();
+        });
+    }
+    to_memory.take();
+
+    bench::section("Status line of 10 fields");
+    std::vector<ts::PresetHandle> field_presets;
+    std::vector<ts::StyleList<ts::Color>> field_styles;
+    for (int i = 0; i < 10; i++)
+    {
+        field_styles.push_back({ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 196 + i)),
+                                ts::Color(ts::Col256(ts::ColorMode::BACKGROUND, 236))});
+        ts::PresetConfig field_preset;
+        field_preset.prefix.prestyles = field_styles.back();
+        field_preset.config.trailing_newline = false;
+        field_presets.push_back(ts::addPreset("field" + std::to_string(i), field_preset));
+    }
+    bench::run("print(handle) x10 -> memory", [&] {
+        for (ts::PresetHandle field : field_presets)
+        {
+            ts::print(to_memory, field, " field ");
+        }
+        return to_memory.take();
+    });
+    ts::StyledText status;
+    bench::run("StyledText x10 fields, print() -> memory", [&] {
+        status.clear();
+        for (const ts::StyleList<ts::Color> &styles : field_styles)
+        {
+            status.append(" field ", styles);
+        }
+        ts::print(to_memory, status);
+        return to_memory.take();
+    });
+
+#if defined(_WIN32)
+    _close(null_fd);
+#else
+    close(null_fd);
+#endif
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * screen.cpp -- measures bytes and time per frame of a 200x50 screen buffer, diffed against redrawing every frame
+*/
+
+#include <random>
+#include "bench.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    constexpr std::size_t width = 200, height = 50;
+
+    ts::SgrState styleOf(ts::Codes code, int background)
+    {
+        ts::SgrState style;
+        style.apply(code);
+        style.apply(ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 0, background));
+        return style;
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    std::mt19937 rng(1);
+    std::vector<std::string> rows[2];
+    std::vector<ts::SgrState> styles[2];
+    for (int frame = 0; frame < 2; frame++)
+    {
+        for (std::size_t y = 0; y < height; y++)
+        {
+            std::string row;
+            for (std::size_t x = 0; x < width; x++) row += static_cast<char>('a' + rng() % 26);
+            rows[frame].push_back(row);
+            styles[frame].push_back(styleOf(static_cast<ts::Codes>(31 + rng() % 7), static_cast<int>(rng() % 64)));
+        }
+    }
+
+    bench::MemoryTarget target;
+    const ts::SgrState green = styleOf(ts::Codes::FOREGROUND_GREEN, 0);
+    const ts::SgrState border = styleOf(ts::Codes::FOREGROUND_BLUE, 40);
+
+    /** Draws a static layout once, then changes a few counters every frame. */
+    auto dashboard = [&](ts::ScreenBuffer &screen, bool redraw) {
+        std::size_t frame = 0;
+        return [&screen, &target, &green, redraw, frame]() mutable {
+            frame++;
+            char counter[16];
+            for (std::size_t i = 0; i < 20; i++)
+            {
+                const int length = std::snprintf(counter, sizeof(counter), "%8zu", frame * (i + 1) % 100000);
+                screen.put(10 + (i % 4) * 40, 5 + i / 4 * 8, std::string_view(counter, static_cast<std::size_t>(length)), green);
+            }
+            if (redraw) screen.invalidate();
+            return screen.flush(target);
+        };
+    };
+    auto layout = [&](ts::ScreenBuffer &screen) {
+        for (std::size_t y = 0; y < height; y++)
+        {
+            screen.put(0, y, std::string(width, y % 8 == 0 ? '-' : ' '), border);
+        }
+        for (std::size_t i = 0; i < 20; i++)
+        {
+            screen.put(i % 4 * 40, 5 + i / 4 * 8, "metric " + std::to_string(i));
+        }
+    };
+
+    bench::section("Full-screen update: every cell changes");
+    {
+        ts::ScreenBuffer screen(width, height);
+        int frame = 0;
+        bench::run("redraw every frame", [&] {
+            frame ^= 1;
+            for (std::size_t y = 0; y < height; y++) screen.put(0, y, rows[frame][y], styles[frame][y]);
+            screen.invalidate();
+            return screen.flush(target);
+        });
+        bench::run("diff against the last frame", [&] {
+            frame ^= 1;
+            for (std::size_t y = 0; y < height; y++) screen.put(0, y, rows[frame][y], styles[frame][y]);
+            return screen.flush(target);
+        });
+    }
+
+    bench::section("Dashboard: 20 counters change");
+    {
+        ts::ScreenBuffer redrawn(width, height), diffed(width, height);
+        layout(redrawn);
+        layout(diffed);
+        bench::run("redraw every frame", dashboard(redrawn, true));
+        bench::run("diff against the last frame", dashboard(diffed, false));
+        bench::run("unchanged frame", [&] { return diffed.flush(target); });
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * strip.cpp -- measures the throughput of stripping styles from captured output against a regex and a byte loop
+*/
+
+#include <chrono>
+#include <regex>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    std::string byteLoop(const std::string &str)
+    {
+        std::string result;
+        result.reserve(str.size());
+        for (std::size_t i = 0; i < str.size(); i++)
+        {
+            if (str[i] == '\033' && i + 1 < str.size() && str[i + 1] == '[')
+            {
+                std::size_t end = i + 2;
+                while (end < str.size() && ((str[end] >= '0' && str[end] <= '9') || str[end] == ';')) end++;
+                if (end < str.size() && str[end] == 'm')
+                {
+                    i = end;
+                    continue;
+                }
+            }
+            result += str[i];
+        }
+        return result;
+    }
+
+    template<typename F>
+    double gbPerSecond(std::size_t bytes, int repeat, F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; i++) f();
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(bytes) * repeat / std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    /**
+     * Captures `lines` log lines printed with a preset into one string.
+     */
+    std::string capture(std::size_t lines, std::size_t width)
+    {
+        ts::RingBufferTarget target(1 << 26);
+        ts::StyledWriter writer(target);
+        const std::string text(width, 'x');
+        for (std::size_t i = 0; i < lines; i++)
+        {
+            writer.print("info", text);
+        }
+        writer.flush();
+        return target.contents();
+    }
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::addPreset("info", {
+        .prefix = {
+            .text = "[INFO] ",
+            .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 200, 80))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+
+    const std::pair<const char *, std::string> inputs[] = {
+        {"short lines (24 chars)", capture(1 << 18, 24)},
+        {"long lines (400 chars)", capture(1 << 15, 400)},
+    };
+    for (const auto &input : inputs)
+    {
+        const std::string &str = input.second;
+        const std::string expected = byteLoop(str);
+        std::string copy, in_place;
+        std::size_t width = 0;
+
+        double regex_gbs = gbPerSecond(str.size() / 16, 1, [&] {
+            static const std::regex sgr("\033\\[[0-9;]*m");
+            copy = std::regex_replace(str.substr(0, str.size() / 16), sgr, "");
+        });
+        double loop_gbs = gbPerSecond(str.size(), 5, [&] { copy = byteLoop(str); });
+        double copy_gbs = gbPerSecond(str.size(), 5, [&] { copy = ts::strip_styles(str); });
+        double in_place_gbs = gbPerSecond(str.size(), 5, [&] {
+            in_place = str;
+            in_place.resize(ts::strip_styles(in_place.data(), in_place.size()));
+        });
+        double width_gbs = gbPerSecond(str.size(), 5, [&] { width = ts::visible_width(str); });
+
+        std::cout << input.first << ", " << str.size() / (1 << 20) << " MiB" << (copy == expected && in_place == expected &&
+                                                                               width == expected.size() ? "" : " (MISMATCH)")
+                  << "\n  std::regex_replace      " << regex_gbs
+                  << " GB/s\n  byte loop               " << loop_gbs
+                  << " GB/s\n  strip_styles (copy)     " << copy_gbs
+                  << " GB/s\n  strip_styles (in place) " << in_place_gbs
+                  << " GB/s (including the copy of the input)\n  visible_width           " << width_gbs << " GB/s\n";
+    }
+    return 0;
+}
@@ -15,6 +15,12 @@
 
 #define TERMSTYLE_NODISCARD [[nodiscard]]
 
+#if defined(__cpp_consteval)
+#define TERMSTYLE_CONSTEVAL consteval
+#else
+#define TERMSTYLE_CONSTEVAL constexpr
+#endif
+
 #define TERMSTYLE_ERROR_DEF(parent, name)                         \
 protected:                                                        \
     name(std::string ename, std::string msg, int exit_code)       \
@@ -107,7 +113,62 @@ class BadColorID : public Error
 
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <tuple>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <initializer_list>
+#include <new>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERMSTYLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TERMSTYLE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 /**
  * @brief Namespace for the termstyle library.
@@ -115,6 +176,150 @@ class BadColorID : public Error
 namespace termstyle
 {
 
+    namespace detail
+    {
+        constexpr std::size_t intLength(int value) noexcept
+        {
+            std::size_t len = value < 0 ? 2 : 1;
+            for (value /= 10; value != 0; value /= 10)
+            {
+                len++;
+            }
+            return len;
+        }
+
+        /**
+         * Writes the decimal representation of `value` to `out` and returns the end of the written range.
+         * Values in 0-999, which covers every color parameter, are written without a loop.
+        */
+        constexpr char *writeInt(char *out, int value) noexcept
+        {
+            if (value >= 0 && value < 1000)
+            {
+                if (value >= 100)
+                {
+                    *out++ = static_cast<char>('0' + value / 100);
+                }
+                if (value >= 10)
+                {
+                    *out++ = static_cast<char>('0' + value / 10 % 10);
+                }
+                *out++ = static_cast<char>('0' + value % 10);
+                return out;
+            }
+            unsigned int magnitude = static_cast<unsigned int>(value);
+            if (value < 0)
+            {
+                *out++ = '-';
+                magnitude = 0u - magnitude;
+            }
+            char digits[10] = {};
+            int count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude != 0);
+            while (count > 0)
+            {
+                *out++ = digits[--count];
+            }
+            return out;
+        }
+
+        /**
+         * Rendering sinks. Every renderer writes through `put()`, so the same code can append to a string,
+         * fill a fixed buffer or feed an output iterator.
+        */
+        struct StringSink
+        {
+            std::string &str;
+
+            void put(const char *data, std::size_t size)
+            {
+                str.append(data, size);
+            }
+        };
+
+        struct BufferSink
+        {
+            char *out;
+            std::size_t cap;
+            std::size_t size = 0;
+
+            void put(const char *data, std::size_t n) noexcept
+            {
+                if (size < cap)
+                {
+                    std::memcpy(out + size, data, std::min(n, cap - size));
+                }
+                size += n;
+            }
+        };
+
+        template<typename OutputIt>
+        struct IteratorSink
+        {
+            OutputIt out;
+
+            void put(const char *data, std::size_t size)
+            {
+                out = std::copy(data, data + size, out);
+            }
+        };
+
+        template<typename Sink>
+        void renderText(Sink &sink, std::string_view text)
+        {
+            if (!text.empty())
+            {
+                sink.put(text.data(), text.size());
+            }
+        }
+
+        /**
+         * Measures and writes the SGR parameters of a style type, e.g. `38;5;28` for a `Col256`.
+         * Specialized next to each style type.
+        */
+        template<typename T, typename = void>
+        struct SgrParam;
+
+        /**
+         * Renders one `\033[...m` sequence with the parameters of `styles` separated by semicolons.
+        */
+        template<typename Sink, typename List>
+        void renderSgrList(Sink &sink, const List &styles)
+        {
+            using T = std::remove_cv_t<std::remove_reference_t<decltype(styles[0])>>;
+            if (styles.empty()) return;
+            sink.put("\033[", 2);
+            for (size_t i = 0; i < styles.size(); i++)
+            {
+                char buf[64];
+                char *end = buf;
+                if (i != 0)
+                {
+                    *end++ = ';';
+                }
+                end = SgrParam<T>::write(end, styles[i]);
+                sink.put(buf, static_cast<std::size_t>(end - buf));
+            }
+            sink.put("m", 1);
+        }
+
+        template<typename Sink, typename T>
+        void renderSgr(Sink &sink, const T &style)
+        {
+            char buf[64];
+            char *end = buf;
+            *end++ = '\033';
+            *end++ = '[';
+            end = SgrParam<T>::write(end, style);
+            *end++ = 'm';
+            sink.put(buf, static_cast<std::size_t>(end - buf));
+        }
+    } // namespace detail
+
     /**
      * @defgroup Col16_group Col16
      * Contents related to Col16.
@@ -176,6 +381,35 @@ namespace termstyle
      * Another simple example.
     */
     
+    namespace detail
+    {
+        template<typename T>
+        struct SgrParam<T, std::enable_if_t<std::is_enum_v<T>>>
+        {
+            static constexpr std::size_t length(T col) noexcept
+            {
+                return intLength(static_cast<int>(col));
+            }
+
+            static constexpr char *write(char *out, T col) noexcept
+            {
+                return writeInt(out, static_cast<int>(col));
+            }
+        };
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, Codes col)
+        {
+            renderSgr(sink, col);
+        }
+
+        template<typename Sink, typename T, std::enable_if_t<std::is_enum_v<T>, int> = 0>
+        void renderStyle(Sink &sink, const std::vector<T> &codelist)
+        {
+            renderSgrList(sink, codelist);
+        }
+    } // namespace detail
+
     /**
      * Converts a vector of Color16 codes to a string representation.
      *
@@ -185,17 +419,9 @@ namespace termstyle
     template<typename T>
     std::string code2string(const std::vector<T>& codelist) noexcept
     {
-        if (codelist.empty()) return "";
-        std::string res = "\033[";
-        for (size_t i = 0; i < codelist.size(); i++)
-        {
-            res += std::to_string(static_cast<int>(codelist[i]));
-            if (i != codelist.size() - 1)
-            {
-                res += ";";
-            }
-        }
-        res += "m";
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderSgrList(sink, codelist);
         return res;
     }
 
@@ -205,9 +431,12 @@ namespace termstyle
      * @param col The code to convert.
      * @return The string representation of the code.
      */
-    std::string code2string(const Codes &col)
+    inline std::string code2string(const Codes &col)
     {
-        return "\033[" + std::to_string(static_cast<int>(col)) + "m";
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderSgr(sink, col);
+        return res;
     }
 
     /** @} */ // end of Col16_group
@@ -246,7 +475,7 @@ namespace termstyle
      * @param ID The color ID to be validated.
      * @return True if the color ID is valid, false otherwise.
      */
-    bool validateColorID(int ID)
+    constexpr bool validateColorID(int ID)
     {
         return ID >= 0 && ID <= 255;
     }
@@ -268,7 +497,7 @@ namespace termstyle
          * @see https://gist.github.com/fnky/458719343aabd01cfb17a3a4f7296797#256-colors
         */
         int ID;
-        explicit Col256(ColorMode mode, int ID) : mode(mode), ID(ID) {
+        constexpr explicit Col256(ColorMode mode, int ID) : mode(mode), ID(ID) {
             if (!validateColorID(ID))
             {
                 throw BadColorID("Invalid color ID: " + std::to_string(ID));
@@ -281,25 +510,50 @@ namespace termstyle
      * This is an example of how to use the Col256 struct.
     */
 
+    namespace detail
+    {
+        template<>
+        struct SgrParam<Col256>
+        {
+            static constexpr std::size_t length(const Col256 &col) noexcept
+            {
+                return intLength(static_cast<int>(col.mode)) + 3 + intLength(col.ID);
+            }
+
+            static constexpr char *write(char *out, const Col256 &col) noexcept
+            {
+                out = writeInt(out, static_cast<int>(col.mode));
+                *out++ = ';';
+                *out++ = '5';
+                *out++ = ';';
+                return writeInt(out, col.ID);
+            }
+        };
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, const Col256 &col)
+        {
+            renderSgr(sink, col);
+        }
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, const std::vector<Col256> &codelist)
+        {
+            renderSgrList(sink, codelist);
+        }
+    } // namespace detail
+
     /**
      * Converts a vector of Col256 objects to a string representation.
      *
      * @param codelist The vector of Col256 objects to convert.
      * @return A string representation of the Col256 objects.
      */
-    std::string col256_2string(std::vector<Col256> codelist) noexcept
+    inline std::string col256_2string(const std::vector<Col256> &codelist) noexcept
     {
-        if (codelist.empty()) return "";
-        std::string res = "\033[";
-        for (size_t i = 0; i < codelist.size(); i++)
-        {
-            res += std::to_string(static_cast<int>(codelist[i].mode)) + ";5;" + std::to_string(codelist[i].ID);
-            if (i != codelist.size() - 1)
-            {
-                res += ";";
-            }
-        }
-        res += "m";
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderSgrList(sink, codelist);
         return res;
     }
     
@@ -309,11 +563,11 @@ namespace termstyle
      * @param col The Col256 object to convert.
      * @return The string representation of the Col256 object.
      */
-    std::string col256_2string(const Col256 &col) noexcept
+    inline std::string col256_2string(const Col256 &col) noexcept
     {
-        std::string res = "\033[";
-        res += std::to_string(static_cast<int>(col.mode)) + ";5;";
-        res += std::to_string(col.ID) + "m";
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderSgr(sink, col);
         return res;
     }
 
@@ -345,7 +599,7 @@ namespace termstyle
          * @param g The green component of the RGB color.
          * @param b The blue component of the RGB color.
          */
-        explicit ColRGB(ColorMode mode, int r, int g, int b) : mode(mode), r(r), g(g), b(b) {}
+        constexpr explicit ColRGB(ColorMode mode, int r, int g, int b) : mode(mode), r(r), g(g), b(b) {}
     };
 
     /**
@@ -353,24 +607,153 @@ namespace termstyle
      * This is an example of how to use the ColRGB struct.
     */
 
+    namespace detail
+    {
+        template<>
+        struct SgrParam<ColRGB>
+        {
+            static constexpr std::size_t length(const ColRGB &col) noexcept
+            {
+                return intLength(static_cast<int>(col.mode)) + 3
+                       + intLength(col.r) + 1 + intLength(col.g) + 1 + intLength(col.b);
+            }
+
+            static constexpr char *write(char *out, const ColRGB &col) noexcept
+            {
+                out = writeInt(out, static_cast<int>(col.mode));
+                *out++ = ';';
+                *out++ = '2';
+                *out++ = ';';
+                out = writeInt(out, col.r);
+                *out++ = ';';
+                out = writeInt(out, col.g);
+                *out++ = ';';
+                return writeInt(out, col.b);
+            }
+        };
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, const ColRGB &col)
+        {
+            renderSgr(sink, col);
+        }
+    } // namespace detail
+
     /**
      * Converts a ColRGB object to a string representation.
      *
      * @param col The ColRGB object to convert.
      * @return The string representation of the ColRGB object.
      */
-    std::string colrgb_2string(const ColRGB &col) noexcept
+    inline std::string colrgb_2string(const ColRGB &col) noexcept
     {
-        std::string res = "\033[";
-        res += std::to_string(static_cast<int>(col.mode)) + ";2;";
-        res += std::to_string(col.r) + ";";
-        res += std::to_string(col.g) + ";";
-        res += std::to_string(col.b) + "m";
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderSgr(sink, col);
         return res;
     }
 
     /** @} */ // end of ColRGB_group
 
+    /**
+     * @defgroup Static_group Compile-time Styles
+     * Content related to escape sequences rendered at compile time.
+     * @{
+    */
+
+    /**
+     * @brief A fixed-size escape sequence rendered at compile time.
+     *
+     * @tparam N The length of the sequence, excluding the terminating null character.
+     */
+    template<std::size_t N>
+    struct StaticSequence
+    {
+        /**
+         * The null-terminated sequence.
+        */
+        char data[N + 1] = {};
+
+        /**
+         * @return The length of the sequence.
+        */
+        constexpr std::size_t size() const noexcept
+        {
+            return N;
+        }
+
+        /**
+         * @return A view of the sequence.
+        */
+        constexpr std::string_view view() const noexcept
+        {
+            return std::string_view(data, N);
+        }
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        constexpr bool is_static_style_v = std::is_same_v<T, Codes> || std::is_same_v<T, Col256> || std::is_same_v<T, ColRGB>;
+
+        template<auto... styles>
+        constexpr std::size_t staticStyleLength() noexcept
+        {
+            if constexpr (sizeof...(styles) == 0)
+            {
+                return 0;
+            }
+            else
+            {
+                return 3 + (SgrParam<std::remove_cv_t<decltype(styles)>>::length(styles) + ...) + (sizeof...(styles) - 1);
+            }
+        }
+
+        template<auto... styles>
+        constexpr StaticSequence<staticStyleLength<styles...>()> makeStaticStyle() noexcept
+        {
+            StaticSequence<staticStyleLength<styles...>()> res{};
+            if constexpr (sizeof...(styles) != 0)
+            {
+                char *out = res.data;
+                *out++ = '\033';
+                *out++ = '[';
+                auto put = [&](const auto &style) {
+                    if (out != res.data + 2)
+                    {
+                        *out++ = ';';
+                    }
+                    out = SgrParam<std::remove_cv_t<std::remove_reference_t<decltype(style)>>>::write(out, style);
+                };
+                (put(styles), ...);
+                *out = 'm';
+            }
+            return res;
+        }
+    } // namespace detail
+
+    /**
+     * @brief An escape sequence for the given styles, rendered at compile time.
+     *
+     * Each style may be a `Codes`, a `Col256` or a `ColRGB`, and all of them are merged into a single sequence.
+     * For example, `static_style<Codes::BRIGHT, Codes::FOREGROUND_RED>` holds `"\033[1;31m"`.
+     *
+     * @tparam styles The styles to apply.
+     */
+    template<auto... styles>
+    inline constexpr auto static_style = [] {
+        static_assert((detail::is_static_style_v<std::remove_cv_t<decltype(styles)>> && ...),
+                      "static_style only accepts Codes, Col256 and ColRGB values");
+        return detail::makeStaticStyle<styles...>();
+    }();
+
+    /**
+     * @brief The sequence printed after text styled with a `StaticSequence`.
+     */
+    inline constexpr StaticSequence<5> static_suffix = {"\033[0m\n"};
+
+    /** @} */ // end of Static_group
+
     /**
      * @defgroup Construct_group Constructing Presets
      * Content related to constructing presets.
@@ -379,351 +762,6674 @@ namespace termstyle
 
     /**
      * @brief Struct for storing different types of colors.
+     *
+     * A color is packed into 4 bytes: the type and the color mode above a 24-bit payload holding the
+     * 16-color code, the 256-color ID or the RGB components. It is trivially copyable and compares by value.
+     * A default-constructed `Color` is uninitialized; use one of the constructors to give it a value.
     */
     struct Color
     {
-        /**
-         * The type of color.
-         * @see ColorType
-        */
-        ColorType type;
-        union {
-            /** @see Codes */
-            Codes col16;
-            /** @see Col256 */
-            Col256 col256;
-            /** @see ColRGB */
-            ColRGB colrgb;
-        };
+    private:
+        std::uint32_t bits;
+
+        static constexpr std::uint32_t type_shift = 24;
+        static constexpr std::uint32_t background_bit = 1u << 26;
+        static constexpr std::uint32_t payload_mask = 0xFFFFFF;
 
+        static constexpr std::uint32_t pack(ColorType type, ColorMode mode, std::uint32_t payload) noexcept
+        {
+            return static_cast<std::uint32_t>(type) << type_shift
+                   | (mode == ColorMode::BACKGROUND ? background_bit : 0u) | (payload & payload_mask);
+        }
+
+        static constexpr std::uint32_t channel(int value) noexcept
+        {
+            return static_cast<std::uint32_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+
+    public:
+        Color() = default;
         /**
          * @brief Constructs a `Color` object with the specified 16-color code.
         */
-        explicit Color(Codes col16) : type(ColorType::COL16), col16(col16) {}
+        constexpr explicit Color(Codes col16) noexcept
+            : bits(pack(ColorType::COL16, ColorMode::FOREGROUND, static_cast<std::uint32_t>(col16))) {}
         /**
          * @brief Constructs a `Color` object with the specified 256-color code.
         */
-        explicit Color(Col256 col256) : type(ColorType::COL256), col256(col256) {}
+        constexpr explicit Color(Col256 col256) noexcept
+            : bits(pack(ColorType::COL256, col256.mode, static_cast<std::uint32_t>(col256.ID))) {}
         /**
-         * @brief Constructs a `Color` object with the specified RGB color.
+         * @brief Constructs a `Color` object with the specified RGB color. Components are clamped to 0-255.
         */
-        explicit Color(ColRGB colrgb) : type(ColorType::COLRGB), colrgb(colrgb) {}
-    };
+        constexpr explicit Color(ColRGB colrgb) noexcept
+            : bits(pack(ColorType::COLRGB, colrgb.mode,
+                        channel(colrgb.r) << 16 | channel(colrgb.g) << 8 | channel(colrgb.b))) {}
 
-    /**
-     * @brief Struct for storing styled strings.
-     */
-    struct StyleString
-    {
         /**
-         * The text to be styled.
+         * @return The type of color.
+         * @see ColorType
         */
-        std::string text = "";
+        constexpr ColorType type() const noexcept
+        {
+            return static_cast<ColorType>((bits >> type_shift) & 3u);
+        }
 
         /**
-         * A vector container that stores objects of type Color, applied before `text`.
-         * 
-         * @see Color
+         * @return The color mode of a 256-color or RGB color. 16-color codes always report `FOREGROUND`.
+         * @see ColorMode
         */
-        std::vector<Color> prestyles = {};
+        constexpr ColorMode mode() const noexcept
+        {
+            return (bits & background_bit) ? ColorMode::BACKGROUND : ColorMode::FOREGROUND;
+        }
 
         /**
-         * A vector container that stores objects of type Color, applied after `text`.
-         * 
-         * @see Color
+         * @return The 16-color code. Only meaningful if `type()` is `ColorType::COL16`.
         */
-        std::vector<Color> poststyles = {};
-
-        /**
-         * A vector container that stores objects of type Codes, applied before `text`.
-         * 
-         * @deprecated
-         * Since v1.0.0-pre.3
-         * Use `prestyles` instead.
-         * 
-         * @see Codes
-         */
-        std::vector<Codes> prestyle16 = {};
+        constexpr Codes col16() const noexcept
+        {
+            return static_cast<Codes>(bits & payload_mask);
+        }
 
         /**
-         * A vector container that stores objects of type Codes, applied after `text`.
-         * 
-         * @deprecated
-         * Since v1.0.0-pre.3
-         * Use `prestyles` instead.
-         * 
-         * @see Codes
+         * @return The 256-color code. Only meaningful if `type()` is `ColorType::COL256`.
         */
-        std::vector<Codes> poststyle16 = {};
+        constexpr Col256 col256() const noexcept
+        {
+            return Col256(mode(), static_cast<int>(bits & 0xFF));
+        }
 
         /**
-         * A vector container that stores objects of type Col256, applied before `text`.
-         * 
-         * @deprecated
-         * Since v1.0.0-pre.3
-         * Use `prestyles` instead.
-         * 
-         * @see Col256
+         * @return The RGB color. Only meaningful if `type()` is `ColorType::COLRGB`.
         */
-        std::vector<Col256> prestlye256 = {};
-        
+        constexpr ColRGB colrgb() const noexcept
+        {
+            return ColRGB(mode(), static_cast<int>((bits >> 16) & 0xFF), static_cast<int>((bits >> 8) & 0xFF),
+                          static_cast<int>(bits & 0xFF));
+        }
+
         /**
-         * A vector container that stores objects of type Col256, applied after `text`.
-         * 
-         * @deprecated
-         * Since v1.0.0-pre.3
-         * Use `prestyles` instead.
-         * 
-         * @see Col256
+         * @return Whether both colors are of the same type and value.
         */
-        std::vector<Col256> poststyle256 = {};
+        friend constexpr bool operator==(Color a, Color b) noexcept
+        {
+            return a.bits == b.bits;
+        }
+
+        friend constexpr bool operator!=(Color a, Color b) noexcept
+        {
+            return a.bits != b.bits;
+        }
     };
 
-    /**
-     * @brief Configuration namespace.
-    */
-    struct Config
+    static_assert(sizeof(Color) == 4 && std::is_trivially_copyable_v<Color>, "Color must stay a packed 4-byte value");
+
+    namespace detail
     {
-        /**
-         * Indicates whether leading restore is enabled or not.
-         * If set to true, it means that leading restore is enabled.
-         * If set to false, leading restore is disabled.
-         */
-        bool leading_restore = true;
-        /**
-         * Indicates whether trailing restore is enabled or not.
-         * If set to true, trailing restore will be performed.
-         * If set to false, trailing restore will be skipped.
-         */
-        bool trailing_restore = true;
+        template<>
+        struct SgrParam<Color>
+        {
+            static constexpr std::size_t length(Color col) noexcept
+            {
+                switch (col.type())
+                {
+                case ColorType::COL256:
+                    return SgrParam<Col256>::length(col.col256());
+                case ColorType::COLRGB:
+                    return SgrParam<ColRGB>::length(col.colrgb());
+                default:
+                    return SgrParam<Codes>::length(col.col16());
+                }
+            }
 
-        /**
-         * Specifies whether a trailing newline character should be added when printing.
-         * If set to true, a newline character will be added at the end of the printed output.
+            static constexpr char *write(char *out, Color col) noexcept
+            {
+                switch (col.type())
+                {
+                case ColorType::COL256:
+                    return SgrParam<Col256>::write(out, col.col256());
+                case ColorType::COLRGB:
+                    return SgrParam<ColRGB>::write(out, col.colrgb());
+                default:
+                    return SgrParam<Codes>::write(out, col.col16());
+                }
+            }
+        };
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, Color col)
+        {
+            renderSgr(sink, col);
+        }
+
+        /**
+         * Renders each color as its own sequence, like `parseColortype()`.
+        */
+        template<typename Sink>
+        void renderStyle(Sink &sink, const std::vector<Color> &codelist)
+        {
+            for (const Color &col : codelist)
+            {
+                renderStyle(sink, col);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief A list of styles that keeps its first few elements inline and only allocates beyond that.
+     *
+     * It provides the parts of the `std::vector` interface used for style lists and is constructible from
+     * a braced list or a `std::vector`, so `.prestyles = {Color(Codes::BRIGHT)}` works as before.
+     * Copying a list that fits inline copies its bytes and never allocates.
+     *
+     * @tparam T The style type, which must be trivially copyable.
+     * @tparam N The number of styles stored inline, by default as many as fit in 16 bytes.
+     */
+    template<typename T, std::size_t N = (sizeof(T) < 16 ? 16 / sizeof(T) : 1)>
+    class StyleList
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "StyleList only stores trivially copyable styles");
+        static_assert(N > 0, "StyleList needs room for at least one inline style");
+
+    private:
+        union
+        {
+            alignas(T) unsigned char local[N * sizeof(T)];
+            T *heap;
+        };
+        std::uint32_t count = 0;
+        std::uint32_t cap = N;
+
+        bool isInline() const noexcept
+        {
+            return cap == N;
+        }
+
+        void grow(std::size_t needed)
+        {
+            const std::size_t next = std::max<std::size_t>(needed, 2 * static_cast<std::size_t>(cap));
+            T *fresh = std::allocator<T>().allocate(next);
+            if (count != 0)
+            {
+                std::memcpy(static_cast<void *>(fresh), data(), count * sizeof(T));
+            }
+            release();
+            heap = fresh;
+            cap = static_cast<std::uint32_t>(next);
+        }
+
+        void release() noexcept
+        {
+            if (!isInline())
+            {
+                std::allocator<T>().deallocate(heap, cap);
+            }
+        }
+
+        template<typename It>
+        void assign(It first, It last)
+        {
+            clear();
+            reserve(static_cast<std::size_t>(std::distance(first, last)));
+            for (; first != last; ++first)
+            {
+                ::new (static_cast<void *>(data() + count)) T(*first);
+                count++;
+            }
+        }
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        StyleList() noexcept {}
+
+        StyleList(std::initializer_list<T> styles)
+        {
+            assign(styles.begin(), styles.end());
+        }
+
+        StyleList(const std::vector<T> &styles)
+        {
+            assign(styles.begin(), styles.end());
+        }
+
+        template<typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+        StyleList(It first, It last)
+        {
+            assign(first, last);
+        }
+
+        StyleList(const StyleList &other)
+        {
+            assign(other.begin(), other.end());
+        }
+
+        StyleList(StyleList &&other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        StyleList &operator=(const StyleList &other)
+        {
+            if (this != &other)
+            {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        StyleList &operator=(StyleList &&other) noexcept
+        {
+            if (this == &other) return *this;
+            release();
+            if (other.isInline())
+            {
+                std::memcpy(local, other.local, sizeof(local));
+            }
+            else
+            {
+                heap = other.heap;
+            }
+            count = other.count;
+            cap = other.cap;
+            other.count = 0;
+            other.cap = N;
+            return *this;
+        }
+
+        StyleList &operator=(std::initializer_list<T> styles)
+        {
+            assign(styles.begin(), styles.end());
+            return *this;
+        }
+
+        ~StyleList()
+        {
+            release();
+        }
+
+        T *data() noexcept
+        {
+            return isInline() ? std::launder(reinterpret_cast<T *>(local)) : heap;
+        }
+
+        const T *data() const noexcept
+        {
+            return isInline() ? std::launder(reinterpret_cast<const T *>(local)) : heap;
+        }
+
+        std::size_t size() const noexcept { return count; }
+        std::size_t capacity() const noexcept { return cap; }
+        bool empty() const noexcept { return count == 0; }
+
+        T *begin() noexcept { return data(); }
+        T *end() noexcept { return data() + count; }
+        const T *begin() const noexcept { return data(); }
+        const T *end() const noexcept { return data() + count; }
+
+        T &operator[](std::size_t i) noexcept { return data()[i]; }
+        const T &operator[](std::size_t i) const noexcept { return data()[i]; }
+        T &front() noexcept { return data()[0]; }
+        const T &front() const noexcept { return data()[0]; }
+        T &back() noexcept { return data()[count - 1]; }
+        const T &back() const noexcept { return data()[count - 1]; }
+
+        /**
+         * @brief Makes room for `n` styles. Never shrinks and never leaves the inline storage for `n <= N`.
+         */
+        void reserve(std::size_t n)
+        {
+            if (n > cap)
+            {
+                grow(n);
+            }
+        }
+
+        void push_back(const T &style)
+        {
+            emplace_back(style);
+        }
+
+        template<typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            // Constructed before growing, as the arguments may refer to an element.
+            const T style(std::forward<Args>(args)...);
+            reserve(count + 1);
+            T *slot = ::new (static_cast<void *>(data() + count)) T(style);
+            count++;
+            return *slot;
+        }
+
+        /**
+         * @brief Inserts `style` before `pos`.
+         * @return An iterator to the inserted style.
+         */
+        T *insert(const T *pos, const T &style)
+        {
+            const std::size_t index = static_cast<std::size_t>(pos - data());
+            const T copy = style;
+            reserve(count + 1);
+            T *at = data() + index;
+            std::memmove(static_cast<void *>(at + 1), at, (count - index) * sizeof(T));
+            ::new (static_cast<void *>(at)) T(copy);
+            count++;
+            return at;
+        }
+
+        /**
+         * @brief Removes the style at `pos`.
+         * @return An iterator to the style after the removed one.
+         */
+        T *erase(const T *pos) noexcept
+        {
+            const std::size_t index = static_cast<std::size_t>(pos - data());
+            T *at = data() + index;
+            std::memmove(static_cast<void *>(at), at + 1, (count - index - 1) * sizeof(T));
+            count--;
+            return at;
+        }
+
+        void pop_back() noexcept
+        {
+            count--;
+        }
+
+        /**
+         * @brief Removes every style, keeping any allocated storage.
+         */
+        void clear() noexcept
+        {
+            count = 0;
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * Renders a list of `Color`s with one sequence per color, like `parseColortype()`, and any other list
+         * as a single sequence, like `code2string()` and `col256_2string()`.
+        */
+        template<typename Sink, typename T, std::size_t N>
+        void renderStyle(Sink &sink, const StyleList<T, N> &styles)
+        {
+            if constexpr (std::is_same_v<T, Color>)
+            {
+                for (Color col : styles)
+                {
+                    renderStyle(sink, col);
+                }
+            }
+            else
+            {
+                renderSgrList(sink, styles);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Struct for storing styled strings.
+     */
+    struct StyleString
+    {
+        /**
+         * The text to be styled.
+        */
+        std::string text = "";
+
+        /**
+         * A list of styles of type Color, applied before `text`.
+         * 
+         * @see Color
+        */
+        StyleList<Color> prestyles = {};
+
+        /**
+         * A list of styles of type Color, applied after `text`.
+         * 
+         * @see Color
+        */
+        StyleList<Color> poststyles = {};
+
+        /**
+         * A list of styles of type Codes, applied before `text`.
+         * 
+         * @deprecated
+         * Since v1.0.0-pre.3
+         * Use `prestyles` instead.
+         * 
+         * @see Codes
+         */
+        StyleList<Codes> prestyle16 = {};
+
+        /**
+         * A list of styles of type Codes, applied after `text`.
+         * 
+         * @deprecated
+         * Since v1.0.0-pre.3
+         * Use `prestyles` instead.
+         * 
+         * @see Codes
+        */
+        StyleList<Codes> poststyle16 = {};
+
+        /**
+         * A list of styles of type Col256, applied before `text`.
+         * 
+         * @deprecated
+         * Since v1.0.0-pre.3
+         * Use `prestyles` instead.
+         * 
+         * @see Col256
+        */
+        StyleList<Col256> prestlye256 = {};
+        
+        /**
+         * A list of styles of type Col256, applied after `text`.
+         * 
+         * @deprecated
+         * Since v1.0.0-pre.3
+         * Use `prestyles` instead.
+         * 
+         * @see Col256
+        */
+        StyleList<Col256> poststyle256 = {};
+    };
+
+    /**
+     * @brief Configuration namespace.
+    */
+    struct Config
+    {
+        /**
+         * Indicates whether leading restore is enabled or not.
+         * If set to true, it means that leading restore is enabled.
+         * If set to false, leading restore is disabled.
+         */
+        bool leading_restore = true;
+        /**
+         * Indicates whether trailing restore is enabled or not.
+         * If set to true, trailing restore will be performed.
+         * If set to false, trailing restore will be skipped.
+         */
+        bool trailing_restore = true;
+
+        /**
+         * Specifies whether a trailing newline character should be added when printing.
+         * If set to true, a newline character will be added at the end of the printed output.
          * If set to false, no newline character will be added.
          */
-        bool trailing_newline = true;
-    };
+        bool trailing_newline = true;
+
+        /**
+         * Specifies whether the styles of each boundary are merged into a single escape sequence.
+         * If set to true, the 16-color, 256-color and `prestyles` / `poststyles` lists before or after a text
+         * are rendered as one sequence, e.g. `"\033[0;1;38;5;28;48;2;0;0;95m"`. The output looks the same and is shorter.
+         * If set to false, each list and each `Color` gets its own sequence.
+         */
+        bool merge_sequences = false;
+    };
+
+    /**
+     * @brief Struct for storing preset configurations.
+     */
+    struct PresetConfig
+    {
+        /** @see StyleString */
+        StyleString prefix;
+        /** @see StyleString */
+        StyleString suffix;
+        /** @see Config */
+        Config config;
+    };
+
+    /** @} */ // end of Construct_group
+
+    /**
+     * @brief A map that stores preset configurations.
+     *
+     * This map is used to store preset configurations for termstyle.
+     * The keys are strings representing the names of the presets,
+     * and the values are instances of the `PresetConfig` class.
+     *
+     * `addPreset()` and the recompile functions modify this map under the registry's writer lock.
+     * Access it directly only while no other thread is registering presets.
+     */
+    inline std::map<std::string, PresetConfig> presets = {};
+
+    /**
+     * @brief Enum class for parse modes.
+     */
+    enum class ParseMode : int
+    {
+        ALL = 0,
+        PREFIX = 1,
+        SUFFIX = 2
+    };
+
+    namespace detail
+    {
+        /**
+         * Renders the parameters of several style lists as a single `\033[...m` sequence.
+        */
+        template<typename Sink>
+        class MergedSgr
+        {
+        private:
+            Sink &sink;
+            bool open = false;
+
+        public:
+            explicit MergedSgr(Sink &sink) : sink(sink) {}
+
+            template<typename List>
+            void add(const List &styles)
+            {
+                for (const auto &style : styles)
+                {
+                    using T = std::remove_cv_t<std::remove_reference_t<decltype(style)>>;
+                    char buf[64];
+                    char *end = buf;
+                    if (open)
+                    {
+                        *end++ = ';';
+                    }
+                    else
+                    {
+                        *end++ = '\033';
+                        *end++ = '[';
+                        open = true;
+                    }
+                    end = SgrParam<T>::write(end, style);
+                    sink.put(buf, static_cast<std::size_t>(end - buf));
+                }
+            }
+
+            void finish()
+            {
+                if (open)
+                {
+                    sink.put("m", 1);
+                    open = false;
+                }
+            }
+        };
+
+        template<typename Sink>
+        void renderMergedStyleString(Sink &sink, const StyleString &str)
+        {
+            MergedSgr<Sink> sgr(sink);
+            sgr.add(str.prestyle16);
+            sgr.add(str.prestlye256);
+            sgr.add(str.prestyles);
+            if (!str.text.empty())
+            {
+                sgr.finish();
+                renderText(sink, str.text);
+            }
+            sgr.add(str.poststyle16);
+            sgr.add(str.poststyle256);
+            sgr.add(str.poststyles);
+            sgr.finish();
+        }
+
+        template<typename Sink>
+        void renderStyleString(Sink &sink, const StyleString &str, bool merge)
+        {
+            if (merge)
+            {
+                renderMergedStyleString(sink, str);
+                return;
+            }
+            renderSgrList(sink, str.prestyle16);
+            renderSgrList(sink, str.prestlye256);
+            renderStyle(sink, str.prestyles);
+            renderText(sink, str.text);
+            renderSgrList(sink, str.poststyle16);
+            renderSgrList(sink, str.poststyle256);
+            renderStyle(sink, str.poststyles);
+        }
+
+        template<typename Sink>
+        void renderStyle(Sink &sink, const PresetConfig &preset, ParseMode mode = ParseMode::ALL)
+        {
+            if (mode == ParseMode::PREFIX || mode == ParseMode::ALL)
+            {
+                renderStyleString(sink, preset.prefix, preset.config.merge_sequences);
+            }
+            if (mode == ParseMode::SUFFIX || mode == ParseMode::ALL)
+            {
+                renderStyleString(sink, preset.suffix, preset.config.merge_sequences);
+                if (preset.config.trailing_newline)
+                {
+                    sink.put("\n", 1);
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * Parses a list of colors and returns a string representing the color type.
+     *
+     * @param codelist The list of colors to be parsed.
+     * @return A string representing the color type.
+     */
+    inline std::string parseColortype(const std::vector<Color> &codelist) noexcept
+    {
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderStyle(sink, codelist);
+        return res;
+    }
+
+    /**
+     * Parses a list of colors, such as the `prestyles` of a `StyleString`, like the overload for `std::vector`.
+     *
+     * @param codelist The list of colors to be parsed.
+     * @return A string representing the color type.
+     */
+    template<std::size_t N>
+    std::string parseColortype(const StyleList<Color, N> &codelist) noexcept
+    {
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderStyle(sink, codelist);
+        return res;
+    }
+
+    /**
+     * Parses the given `preset` configuration using the specified `mode`.
+     *
+     * @param preset The preset configuration to parse.
+     * @param mode The parse mode to use (default: `ParseMode::ALL`).
+     * @return A string representing the parsed configuration.
+     */
+    inline std::string parse(const PresetConfig &preset, ParseMode mode = ParseMode::ALL) noexcept
+    {
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderStyle(sink, preset, mode);
+        return res;
+    }
+
+    /**
+     * @defgroup Render_group Rendering into Buffers
+     * Content related to rendering escape sequences without allocating.
+     *
+     * `style` may be a `Codes`, `Col256`, `ColRGB` or `Color`, a `std::vector` of any of them, or a `PresetConfig`.
+     * The output is identical to that of `code2string()`, `col256_2string()`, `colrgb_2string()`, `parseColortype()`
+     * and `parse()` respectively.
+     * @{
+    */
+
+    /**
+     * Appends the escape sequence of `style` to `out`.
+     *
+     * @param out The string to append to. It only allocates if its capacity is exceeded.
+     * @param style The style to render.
+     */
+    template<typename T>
+    void append_to(std::string &out, const T &style)
+    {
+        detail::StringSink sink{out};
+        detail::renderStyle(sink, style);
+    }
+
+    /**
+     * Appends the given part of `preset` to `out`.
+     *
+     * @param out The string to append to. It only allocates if its capacity is exceeded.
+     * @param preset The preset configuration to render.
+     * @param mode The parse mode to use.
+     */
+    inline void append_to(std::string &out, const PresetConfig &preset, ParseMode mode)
+    {
+        detail::StringSink sink{out};
+        detail::renderStyle(sink, preset, mode);
+    }
+
+    /**
+     * Renders the escape sequence of `style` into a fixed buffer. Never allocates.
+     *
+     * @param out The buffer to write to. It is not null-terminated.
+     * @param cap The capacity of `out`. If the result is longer, only the first `cap` bytes are written.
+     * @param style The style to render.
+     * @return The full length of the result, which may exceed `cap`.
+     */
+    template<typename T>
+    std::size_t render_to(char *out, std::size_t cap, const T &style) noexcept
+    {
+        detail::BufferSink sink{out, cap};
+        detail::renderStyle(sink, style);
+        return sink.size;
+    }
+
+    /**
+     * Renders the given part of `preset` into a fixed buffer. Never allocates.
+     *
+     * @param out The buffer to write to. It is not null-terminated.
+     * @param cap The capacity of `out`. If the result is longer, only the first `cap` bytes are written.
+     * @param preset The preset configuration to render.
+     * @param mode The parse mode to use.
+     * @return The full length of the result, which may exceed `cap`.
+     */
+    inline std::size_t render_to(char *out, std::size_t cap, const PresetConfig &preset, ParseMode mode) noexcept
+    {
+        detail::BufferSink sink{out, cap};
+        detail::renderStyle(sink, preset, mode);
+        return sink.size;
+    }
+
+    /**
+     * Renders the escape sequence of `style` into an output iterator.
+     *
+     * @param out The output iterator to write to.
+     * @param style The style to render.
+     * @return The output iterator past the last written character.
+     */
+    template<typename OutputIt, typename T>
+    OutputIt render_to(OutputIt out, const T &style)
+    {
+        detail::IteratorSink<OutputIt> sink{out};
+        detail::renderStyle(sink, style);
+        return sink.out;
+    }
+
+    /**
+     * Renders the given part of `preset` into an output iterator.
+     *
+     * @param out The output iterator to write to.
+     * @param preset The preset configuration to render.
+     * @param mode The parse mode to use.
+     * @return The output iterator past the last written character.
+     */
+    template<typename OutputIt>
+    OutputIt render_to(OutputIt out, const PresetConfig &preset, ParseMode mode)
+    {
+        detail::IteratorSink<OutputIt> sink{out};
+        detail::renderStyle(sink, preset, mode);
+        return sink.out;
+    }
+
+    /** @} */ // end of Render_group
+
+    /**
+     * @defgroup State_group Terminal State
+     * Content related to tracking the SGR state of the terminal and emitting only what changes.
+     * @{
+    */
+
+    /**
+     * @brief The SGR state of a terminal: the active attributes and the foreground and background colors.
+     *
+     * Applying a style to a state mirrors what the terminal does when it receives the escape sequence,
+     * so the state after a sequence of styles is known without looking at the terminal.
+     * `transition()` renders the shortest sequence that takes the terminal from one state to another.
+     */
+    struct SgrState
+    {
+        /**
+         * The active attributes, with bit `n` set for the `Codes` value `n` (`BRIGHT` to `STRIKE`).
+        */
+        std::uint16_t attributes = 0;
+
+        /**
+         * The foreground color. `Codes::FOREGROUND_RESET` is the terminal's default.
+        */
+        Color foreground = Color(Codes::FOREGROUND_RESET);
+
+        /**
+         * The background color. `Codes::BACKGROUND_RESET` is the terminal's default.
+        */
+        Color background = Color(Codes::BACKGROUND_RESET);
+
+        /**
+         * @brief Applies a 16-color code, an attribute or a reset code.
+         */
+        void apply(Codes code) noexcept
+        {
+            const int value = static_cast<int>(code);
+            if (code == Codes::RESTORE)
+            {
+                attributes = 0;
+                foreground = Color(Codes::FOREGROUND_RESET);
+                background = Color(Codes::BACKGROUND_RESET);
+            }
+            else if (value >= 1 && value <= 9 && value != 6)
+            {
+                attributes |= static_cast<std::uint16_t>(1u << value);
+            }
+            else if (code == Codes::BRIGHT_RESET)
+            {
+                attributes &= static_cast<std::uint16_t>(~((1u << 1) | (1u << 2)));
+            }
+            else if (value >= 23 && value <= 29)
+            {
+                attributes &= static_cast<std::uint16_t>(~(1u << (value - 20)));
+            }
+            else if (value >= 30 && value <= 39 && value != 38)
+            {
+                foreground = Color(code);
+            }
+            else if (value >= 40 && value <= 49 && value != 48)
+            {
+                background = Color(code);
+            }
+        }
+
+        /**
+         * @brief Applies a 256-color code.
+         */
+        void apply(const Col256 &col) noexcept
+        {
+            (col.mode == ColorMode::FOREGROUND ? foreground : background) = Color(col);
+        }
+
+        /**
+         * @brief Applies an RGB color.
+         */
+        void apply(const ColRGB &col) noexcept
+        {
+            (col.mode == ColorMode::FOREGROUND ? foreground : background) = Color(col);
+        }
+
+        /**
+         * @brief Applies any type of color.
+         */
+        void apply(Color col) noexcept
+        {
+            if (col.type() == ColorType::COL16)
+            {
+                apply(col.col16());
+            }
+            else
+            {
+                (col.mode() == ColorMode::FOREGROUND ? foreground : background) = col;
+            }
+        }
+
+        /**
+         * @brief Applies every style of `styles` in order.
+         */
+        template<typename T>
+        void apply(const std::vector<T> &styles) noexcept
+        {
+            for (const T &style : styles)
+            {
+                apply(style);
+            }
+        }
+
+        template<typename T, std::size_t N>
+        void apply(const StyleList<T, N> &styles) noexcept
+        {
+            for (const T &style : styles)
+            {
+                apply(style);
+            }
+        }
+
+        /**
+         * @return Whether this is the terminal's default state.
+        */
+        bool isDefault() const noexcept
+        {
+            return attributes == 0 && foreground == Color(Codes::FOREGROUND_RESET)
+                   && background == Color(Codes::BACKGROUND_RESET);
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * Collects SGR parameters into a single `\033[...m` sequence on the stack.
+         * Large enough for a reset, every attribute and two RGB colors with arbitrary `int` channels.
+        */
+        class SgrBuilder
+        {
+        private:
+            char data[160];
+            std::size_t size = 2;
+
+        public:
+            SgrBuilder() noexcept
+            {
+                data[0] = '\033';
+                data[1] = '[';
+            }
+
+            template<typename T>
+            void add(const T &param) noexcept
+            {
+                if (size != 2)
+                {
+                    data[size++] = ';';
+                }
+                size = static_cast<std::size_t>(SgrParam<T>::write(data + size, param) - data);
+            }
+
+            bool empty() const noexcept
+            {
+                return size == 2;
+            }
+
+            /**
+             * The length of the finished sequence, including the final `m`.
+            */
+            std::size_t length() const noexcept
+            {
+                return size + 1;
+            }
+
+            template<typename Sink>
+            void renderTo(Sink &sink) noexcept(noexcept(sink.put(data, size)))
+            {
+                data[size] = 'm';
+                sink.put(data, size + 1);
+            }
+        };
+
+        inline constexpr Codes sgr_attributes[] = {Codes::BRIGHT, Codes::DIM, Codes::ITALIC, Codes::UNDERLINE,
+                                                   Codes::FLASH, Codes::REVERSE, Codes::HIDDEN, Codes::STRIKE};
+
+        inline bool hasAttribute(std::uint16_t attributes, Codes code) noexcept
+        {
+            return (attributes >> static_cast<int>(code)) & 1u;
+        }
+
+        /**
+         * Renders the shortest sequence that takes the terminal from `from` to `to`: either the parameters
+         * that differ, or a reset followed by the whole of `to`.
+        */
+        template<typename Sink>
+        void renderTransition(Sink &sink, const SgrState &from, const SgrState &to)
+        {
+            const bool same_foreground = from.foreground == to.foreground;
+            const bool same_background = from.background == to.background;
+            if (from.attributes == to.attributes && same_foreground && same_background) return;
+            // A lone reset is the shortest way to the default state.
+            if (to.isDefault())
+            {
+                sink.put("\033[0m", 4);
+                return;
+            }
+
+            SgrBuilder diff;
+            std::uint16_t removed = from.attributes & ~to.attributes;
+            std::uint16_t added = to.attributes & ~from.attributes;
+            const std::uint16_t intensity = (1u << 1) | (1u << 2);
+            if (removed & intensity)
+            {
+                // 22 clears both bright and dim, so the one that stays has to be set again.
+                diff.add(Codes::BRIGHT_RESET);
+                removed &= static_cast<std::uint16_t>(~intensity);
+                added |= to.attributes & intensity;
+            }
+            for (Codes code : sgr_attributes)
+            {
+                if (hasAttribute(removed, code)) diff.add(static_cast<Codes>(static_cast<int>(code) + 20));
+            }
+            for (Codes code : sgr_attributes)
+            {
+                if (hasAttribute(added, code)) diff.add(code);
+            }
+            if (!same_foreground) diff.add(to.foreground);
+            if (!same_background) diff.add(to.background);
+
+            // Without anything to switch off, the changes are a subset of the full state.
+            const bool nothing_removed = from.attributes == (from.attributes & to.attributes)
+                                         && (same_foreground || to.foreground != Color(Codes::FOREGROUND_RESET))
+                                         && (same_background || to.background != Color(Codes::BACKGROUND_RESET));
+            if (nothing_removed)
+            {
+                diff.renderTo(sink);
+                return;
+            }
+
+            SgrBuilder full;
+            full.add(Codes::RESTORE);
+            for (Codes code : sgr_attributes)
+            {
+                if (hasAttribute(to.attributes, code)) full.add(code);
+            }
+            if (to.foreground != Color(Codes::FOREGROUND_RESET)) full.add(to.foreground);
+            if (to.background != Color(Codes::BACKGROUND_RESET)) full.add(to.background);
+
+            if (diff.length() <= full.length())
+            {
+                diff.renderTo(sink);
+            }
+            else
+            {
+                full.renderTo(sink);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * Compares two states.
+     *
+     * @return Whether the terminal looks the same in both states.
+     */
+    inline bool operator==(const SgrState &a, const SgrState &b) noexcept
+    {
+        return a.attributes == b.attributes && a.foreground == b.foreground && a.background == b.background;
+    }
+
+    inline bool operator!=(const SgrState &a, const SgrState &b) noexcept
+    {
+        return !(a == b);
+    }
+
+    /**
+     * Renders the shortest escape sequence that takes the terminal from one state to another.
+     *
+     * For example, going from bold red to bold green only emits `"\033[32m"`, going from bold red to
+     * plain red emits `"\033[22m"` and going from bold red to plain green emits `"\033[0;32m"`.
+     * No sequence is emitted if the states are equal.
+     *
+     * @param from The current state of the terminal.
+     * @param to The state to switch to.
+     * @return The escape sequence, possibly empty.
+     */
+    inline std::string transition(const SgrState &from, const SgrState &to)
+    {
+        std::string res;
+        detail::StringSink sink{res};
+        detail::renderTransition(sink, from, to);
+        return res;
+    }
+
+    /** @} */ // end of State_group
+
+    /**
+     * @defgroup Capability_group Terminal Capabilities
+     * Content related to detecting what the terminal supports and downgrading colors to match.
+     * @{
+    */
+
+    /**
+     * @brief Enum class for the color support levels of a terminal.
+     */
+    enum class ColorSupport : int
+    {
+        /** No escape sequences at all, e.g. when writing to a pipe or when `NO_COLOR` is set. */
+        NONE = 0,
+        /** The 16 colors and attributes of `Codes`. */
+        COL16 = 1,
+        /** `Col256` colors. */
+        COL256 = 2,
+        /** `ColRGB` colors. */
+        COLRGB = 3
+    };
+
+    /**
+     * @brief Detects the color support of the terminal behind a file descriptor.
+     *
+     * The rules are, in order:
+     * - `NO_COLOR` set to a non-empty value disables colors.
+     * - `FORCE_COLOR` set to `0`, `1`, `2` or `3` selects `NONE`, `COL16`, `COL256` or `COLRGB` (any other value selects `COL16`).
+     * - A file descriptor that is not a terminal, or `TERM=dumb`, disables colors. A negative `fd` stands for
+     *   output that has no file descriptor, like a file or string stream.
+     * - `COLORTERM=truecolor` or `COLORTERM=24bit` selects `COLRGB`, and a `TERM` containing `256color` selects `COL256`.
+     * - Otherwise `COL16` is assumed, except on Windows where terminals without `TERM` support `COLRGB`.
+     *
+     * @param fd The file descriptor to inspect (default: standard output).
+     * @return The detected color support.
+     */
+    inline ColorSupport detectColorSupport(int fd = 1) noexcept
+    {
+        const char *no_color = std::getenv("NO_COLOR");
+        if (no_color != nullptr && no_color[0] != '\0')
+        {
+            return ColorSupport::NONE;
+        }
+        const char *force_color = std::getenv("FORCE_COLOR");
+        if (force_color != nullptr && force_color[0] != '\0')
+        {
+            if (force_color[1] == '\0' && force_color[0] >= '0' && force_color[0] <= '3')
+            {
+                return static_cast<ColorSupport>(force_color[0] - '0');
+            }
+            return ColorSupport::COL16;
+        }
+#if defined(_WIN32)
+        if (fd < 0 || !_isatty(fd))
+#else
+        if (fd < 0 || !isatty(fd))
+#endif
+        {
+            return ColorSupport::NONE;
+        }
+        const char *term = std::getenv("TERM");
+        if (term != nullptr && std::strcmp(term, "dumb") == 0)
+        {
+            return ColorSupport::NONE;
+        }
+        const char *colorterm = std::getenv("COLORTERM");
+        if (colorterm != nullptr && (std::strcmp(colorterm, "truecolor") == 0 || std::strcmp(colorterm, "24bit") == 0))
+        {
+            return ColorSupport::COLRGB;
+        }
+        if (term != nullptr && std::strstr(term, "256color") != nullptr)
+        {
+            return ColorSupport::COL256;
+        }
+#if defined(_WIN32)
+        if (term == nullptr)
+        {
+            return ColorSupport::COLRGB;
+        }
+#endif
+        return ColorSupport::COL16;
+    }
+
+    namespace detail
+    {
+        inline std::atomic<int> color_support{-1};
+        /** Whether `color_support` was set with `setColorSupport()` rather than detected. */
+        inline std::atomic<bool> color_support_set{false};
+    } // namespace detail
+
+    /**
+     * @brief Returns the color support of standard output, used where output has no `OutputTarget`,
+     * such as `append_to()`, `render()` and `styled()`.
+     *
+     * Detected from standard output with `detectColorSupport()` on first use, unless set with `setColorSupport()`.
+     * Each `OutputTarget` detects its own color support; see `OutputTarget::colorSupport()`.
+     */
+    inline ColorSupport getColorSupport() noexcept
+    {
+        int support = detail::color_support.load(std::memory_order_relaxed);
+        if (support < 0)
+        {
+            support = static_cast<int>(detectColorSupport());
+            int expected = -1;
+            if (!detail::color_support.compare_exchange_strong(expected, support, std::memory_order_relaxed))
+            {
+                support = expected;
+            }
+        }
+        return static_cast<ColorSupport>(support);
+    }
+
+    namespace detail
+    {
+        /** The detected color support of standard error, and of output without a file descriptor, or -1. */
+        inline std::atomic<int> stderr_support{-1};
+        inline std::atomic<int> unattached_support{-1};
+
+        inline ColorSupport detectOnce(std::atomic<int> &cache, int fd) noexcept
+        {
+            int support = cache.load(std::memory_order_relaxed);
+            if (support < 0)
+            {
+                support = static_cast<int>(detectColorSupport(fd));
+                cache.store(support, std::memory_order_relaxed);
+            }
+            return static_cast<ColorSupport>(support);
+        }
+
+        /**
+         * The color support of a stream: that of the terminal behind `std::cout`, `std::cerr` or `std::clog`, and
+         * that of output without a file descriptor for other streams. `setColorSupport()` overrides it.
+        */
+        inline ColorSupport streamColorSupport(const std::ostream &os) noexcept
+        {
+            if (&os == &std::cout || color_support_set.load(std::memory_order_relaxed))
+            {
+                return getColorSupport();
+            }
+            if (&os == &std::cerr || &os == &std::clog)
+            {
+                return detectOnce(stderr_support, 2);
+            }
+            return detectOnce(unattached_support, -1);
+        }
+    } // namespace detail
+
+    namespace detail
+    {
+        /**
+         * The RGB values of the xterm 256-color palette.
+        */
+        constexpr ColRGB paletteColor(int ID, ColorMode mode = ColorMode::FOREGROUND) noexcept
+        {
+            constexpr int system[16][3] = {
+                {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0},
+                {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+                {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0},
+                {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}
+            };
+            constexpr int levels[6] = {0, 95, 135, 175, 215, 255};
+            if (ID < 16)
+            {
+                return ColRGB(mode, system[ID][0], system[ID][1], system[ID][2]);
+            }
+            if (ID < 232)
+            {
+                ID -= 16;
+                return ColRGB(mode, levels[ID / 36], levels[ID / 6 % 6], levels[ID % 6]);
+            }
+            int gray = 8 + (ID - 232) * 10;
+            return ColRGB(mode, gray, gray, gray);
+        }
+
+        constexpr int clampChannel(int value) noexcept
+        {
+            return value < 0 ? 0 : (value > 255 ? 255 : value);
+        }
+
+        constexpr int cubeLevel(int value) noexcept
+        {
+            // Midpoints between the cube levels 0, 95, 135, 175, 215 and 255.
+            return value < 48 ? 0 : (value < 115 ? 1 : (value - 35) / 40);
+        }
+
+        constexpr Codes codesFor(int index, ColorMode mode) noexcept
+        {
+            return static_cast<Codes>((mode == ColorMode::FOREGROUND ? 30 : 40) + index % 8);
+        }
+
+        /**
+         * Lookup tables for quantizing RGB colors, built at compile time.
+        */
+        struct QuantizeTables
+        {
+            /** The RGB value of every `Col256` ID. */
+            std::uint8_t palette[256][3];
+            /** The nearest cube level (0-5) of a channel value. */
+            std::uint8_t cube[256];
+            /** The nearest grayscale ramp ID (232-255) of a channel average. */
+            std::uint8_t gray[256];
+            /** The 16 system colors, one row per channel, laid out for the distance kernel. */
+            int system[3][16];
+        };
+
+        inline constexpr QuantizeTables quantize_tables = [] {
+            QuantizeTables t{};
+            for (int i = 0; i < 256; i++)
+            {
+                ColRGB col = paletteColor(i);
+                t.palette[i][0] = static_cast<std::uint8_t>(col.r);
+                t.palette[i][1] = static_cast<std::uint8_t>(col.g);
+                t.palette[i][2] = static_cast<std::uint8_t>(col.b);
+                t.cube[i] = static_cast<std::uint8_t>(cubeLevel(i));
+                t.gray[i] = static_cast<std::uint8_t>(i < 8 ? 232 : (i > 238 ? 255 : 232 + (i - 3) / 10));
+            }
+            for (int i = 0; i < 16; i++)
+            {
+                ColRGB col = paletteColor(i);
+                t.system[0][i] = col.r;
+                t.system[1][i] = col.g;
+                t.system[2][i] = col.b;
+            }
+            return t;
+        }();
+
+        /**
+         * Returns the nearest ID in the color cube and grayscale ramp (16-255) of a clamped RGB value.
+        */
+        constexpr int nearest256(int r, int g, int b) noexcept
+        {
+            const QuantizeTables &t = quantize_tables;
+            int cube = 16 + 36 * t.cube[r] + 6 * t.cube[g] + t.cube[b];
+            int gray = t.gray[(r + g + b) / 3];
+            int cr = r - t.palette[cube][0], cg = g - t.palette[cube][1], cb = b - t.palette[cube][2];
+            int gr = r - t.palette[gray][0], gg = g - t.palette[gray][1], gb = b - t.palette[gray][2];
+            return gr * gr + gg * gg + gb * gb < cr * cr + cg * cg + cb * cb ? gray : cube;
+        }
+
+        /**
+         * Returns the index (0-15) of the nearest system color of a clamped RGB value.
+        */
+        constexpr int nearest16(int r, int g, int b) noexcept
+        {
+            const QuantizeTables &t = quantize_tables;
+            int best = 0;
+            int best_distance = 3 * 256 * 256;
+            for (int i = 0; i < 16; i++)
+            {
+                int dr = r - t.system[0][i], dg = g - t.system[1][i], db = b - t.system[2][i];
+                int d = dr * dr + dg * dg + db * db;
+                best = d < best_distance ? i : best;
+                best_distance = d < best_distance ? d : best_distance;
+            }
+            return best;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Returns the RGB value of a `Col256` color in the xterm palette.
+     *
+     * @param col The color to convert.
+     * @return The RGB color, with the same mode.
+     */
+    constexpr ColRGB toColRGB(const Col256 &col) noexcept
+    {
+        return detail::paletteColor(col.ID, col.mode);
+    }
+
+    /**
+     * @brief Finds the closest color of the xterm 256-color cube and grayscale ramp.
+     *
+     * @param col The color to convert. Components are clamped to 0-255.
+     * @return The closest `Col256` color, with the same mode.
+     */
+    constexpr Col256 toCol256(const ColRGB &col) noexcept
+    {
+        return Col256(col.mode, detail::nearest256(detail::clampChannel(col.r), detail::clampChannel(col.g),
+                                                   detail::clampChannel(col.b)));
+    }
+
+    /**
+     * @brief Finds the closest of the 8 foreground or background colors of `Codes`.
+     *
+     * Bright variants of the 16-color palette are matched too and map to the same code.
+     *
+     * @param col The color to convert. Components are clamped to 0-255.
+     * @return The closest `Codes` color for the mode of `col`.
+     */
+    constexpr Codes toCodes(const ColRGB &col) noexcept
+    {
+        return detail::codesFor(detail::nearest16(detail::clampChannel(col.r), detail::clampChannel(col.g),
+                                                  detail::clampChannel(col.b)), col.mode);
+    }
+
+    /**
+     * @brief Finds the closest of the 8 foreground or background colors of `Codes`.
+     *
+     * @param col The color to convert.
+     * @return The closest `Codes` color for the mode of `col`.
+     */
+    constexpr Codes toCodes(const Col256 &col) noexcept
+    {
+        return col.ID < 16 ? detail::codesFor(col.ID, col.mode) : toCodes(toColRGB(col));
+    }
+
+    /**
+     * @brief Converts an array of RGB colors to `Col256` IDs, like `toCol256()` for each element.
+     *
+     * @param colors The colors to convert.
+     * @param count The number of colors.
+     * @param ids Receives `count` IDs, usable as `Col256(colors[i].mode, ids[i])`.
+     */
+    inline void toCol256(const ColRGB *colors, std::size_t count, std::uint8_t *ids) noexcept
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            ids[i] = static_cast<std::uint8_t>(detail::nearest256(detail::clampChannel(colors[i].r),
+                                                                  detail::clampChannel(colors[i].g),
+                                                                  detail::clampChannel(colors[i].b)));
+        }
+    }
+
+    /**
+     * @brief Converts an array of RGB colors to `Codes`, like `toCodes()` for each element.
+     *
+     * Colors are processed in blocks, comparing a whole block against one palette entry at a time,
+     * so that the distance computation vectorizes.
+     *
+     * @param colors The colors to convert.
+     * @param count The number of colors.
+     * @param codes Receives `count` codes.
+     */
+    inline void toCodes(const ColRGB *colors, std::size_t count, Codes *codes) noexcept
+    {
+        constexpr int block = 64;
+        const detail::QuantizeTables &t = detail::quantize_tables;
+        int r[block] = {}, g[block] = {}, b[block] = {}, best[block], best_distance[block];
+        for (std::size_t start = 0; start < count; start += block)
+        {
+            int n = static_cast<int>(std::min<std::size_t>(block, count - start));
+            for (int j = 0; j < n; j++)
+            {
+                r[j] = detail::clampChannel(colors[start + j].r);
+                g[j] = detail::clampChannel(colors[start + j].g);
+                b[j] = detail::clampChannel(colors[start + j].b);
+            }
+            for (int j = 0; j < block; j++)
+            {
+                best[j] = 0;
+                best_distance[j] = 3 * 256 * 256;
+            }
+            // Always runs over the whole block so that the trip count is constant.
+            for (int i = 0; i < 16; i++)
+            {
+                const int pr = t.system[0][i], pg = t.system[1][i], pb = t.system[2][i];
+                for (int j = 0; j < block; j++)
+                {
+                    int dr = r[j] - pr, dg = g[j] - pg, db = b[j] - pb;
+                    int d = dr * dr + dg * dg + db * db;
+                    bool closer = d < best_distance[j];
+                    best[j] = closer ? i : best[j];
+                    best_distance[j] = closer ? d : best_distance[j];
+                }
+            }
+            for (int j = 0; j < n; j++)
+            {
+                codes[start + j] = detail::codesFor(best[j], colors[start + j].mode);
+            }
+        }
+    }
+
+    namespace detail
+    {
+        inline void downgradeColor(Color &col, ColorSupport support)
+        {
+            if (col.type() == ColorType::COLRGB && support == ColorSupport::COL256)
+            {
+                col = Color(toCol256(col.colrgb()));
+            }
+            else if (col.type() == ColorType::COLRGB && support == ColorSupport::COL16)
+            {
+                col = Color(toCodes(col.colrgb()));
+            }
+            else if (col.type() == ColorType::COL256 && support == ColorSupport::COL16)
+            {
+                col = Color(toCodes(col.col256()));
+            }
+        }
+
+        inline void downgradeColors(StyleList<Color> &colors, ColorSupport support)
+        {
+            for (Color &col : colors)
+            {
+                downgradeColor(col, support);
+            }
+        }
+
+        inline void downgradeStyleString(StyleString &str, ColorSupport support)
+        {
+            if (support == ColorSupport::NONE)
+            {
+                str.prestyles.clear();
+                str.poststyles.clear();
+                str.prestyle16.clear();
+                str.poststyle16.clear();
+                str.prestlye256.clear();
+                str.poststyle256.clear();
+                return;
+            }
+            downgradeColors(str.prestyles, support);
+            downgradeColors(str.poststyles, support);
+            if (support == ColorSupport::COL16)
+            {
+                // The deprecated 256-color lists are rendered right after the 16-color lists.
+                for (const Col256 &col : str.prestlye256)
+                {
+                    str.prestyle16.push_back(toCodes(col));
+                }
+                for (const Col256 &col : str.poststyle256)
+                {
+                    str.poststyle16.push_back(toCodes(col));
+                }
+                str.prestlye256.clear();
+                str.poststyle256.clear();
+            }
+        }
+    } // namespace detail
+
+    namespace detail
+    {
+        /**
+         * The state a terminal with the given color support shows for `state`.
+        */
+        inline SgrState downgradeState(SgrState state, ColorSupport support)
+        {
+            if (support == ColorSupport::NONE) return SgrState();
+            downgradeColor(state.foreground, support);
+            downgradeColor(state.background, support);
+            return state;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Downgrades every color of a preset to what the given support level can display.
+     *
+     * `ColRGB` colors become the nearest `Col256`, and those become the nearest `Codes` color.
+     * With `ColorSupport::NONE`, every style is removed and only the texts remain.
+     *
+     * @param preset The preset configuration to downgrade.
+     * @param support The color support to downgrade to.
+     * @return The downgraded preset configuration.
+     */
+    inline PresetConfig downgradePreset(PresetConfig preset, ColorSupport support)
+    {
+        if (support != ColorSupport::COLRGB)
+        {
+            detail::downgradeStyleString(preset.prefix, support);
+            detail::downgradeStyleString(preset.suffix, support);
+        }
+        return preset;
+    }
+
+    /** @} */ // end of Capability_group
+
+    /**
+     * @defgroup Inline_group Inline Styles
+     * Content related to composing styles in place, without registering a preset.
+     * @{
+    */
+
+    /**
+     * @brief A composition of styles, built with `fg()`, `bg()`, the attribute constants and `operator|`.
+     *
+     * The styles are only stored, in order, and nothing is rendered until the expression is printed or inserted
+     * into a stream with `styled()`. Expressions never allocate and can be built in constant expressions,
+     * e.g. `constexpr auto alert = fg(Codes::FOREGROUND_RED) | bold;`.
+     *
+     * @tparam Styles The types of the styles: `Codes`, `Col256`, `ColRGB` or `Color`.
+     */
+    template<typename... Styles>
+    class StyleExpr
+    {
+        static_assert(((detail::is_static_style_v<Styles> || std::is_same_v<Styles, Color>) && ...),
+                      "StyleExpr only accepts Codes, Col256, ColRGB and Color values");
+
+    public:
+        /**
+         * The styles, in the order they are applied.
+        */
+        std::tuple<Styles...> styles;
+
+        constexpr explicit StyleExpr(Styles... styles) : styles(styles...) {}
+
+        constexpr explicit StyleExpr(std::tuple<Styles...> styles) : styles(styles) {}
+
+        /**
+         * @param res The state of the terminal before the styles, by default its default state.
+         * @return The state of the terminal after applying the styles.
+        */
+        SgrState state(SgrState res = SgrState()) const noexcept
+        {
+            std::apply([&res](const auto &...style) { (res.apply(style), ...); }, styles);
+            return res;
+        }
+    };
+
+    /**
+     * Combines two style expressions. The styles of `b` are applied after those of `a`.
+     */
+    template<typename... A, typename... B>
+    constexpr StyleExpr<A..., B...> operator|(const StyleExpr<A...> &a, const StyleExpr<B...> &b)
+    {
+        return StyleExpr<A..., B...>(std::tuple_cat(a.styles, b.styles));
+    }
+
+    /** @brief Bright or bold text. */
+    inline constexpr StyleExpr<Codes> bold{Codes::BRIGHT};
+    /** @brief Dim text. */
+    inline constexpr StyleExpr<Codes> dim{Codes::DIM};
+    /** @brief Italic text. */
+    inline constexpr StyleExpr<Codes> italic{Codes::ITALIC};
+    /** @brief Underlined text. */
+    inline constexpr StyleExpr<Codes> underline{Codes::UNDERLINE};
+    /** @brief Flashing text. */
+    inline constexpr StyleExpr<Codes> flash{Codes::FLASH};
+    /** @brief Text with the foreground and background colors swapped. */
+    inline constexpr StyleExpr<Codes> reverse{Codes::REVERSE};
+    /** @brief Hidden text. */
+    inline constexpr StyleExpr<Codes> hidden{Codes::HIDDEN};
+    /** @brief Struck-through text. */
+    inline constexpr StyleExpr<Codes> strike{Codes::STRIKE};
+
+    /**
+     * @brief A 16-color foreground. Background codes are turned into the matching foreground code.
+     */
+    constexpr StyleExpr<Codes> fg(Codes col)
+    {
+        const int value = static_cast<int>(col);
+        return StyleExpr<Codes>(value >= 40 && value <= 49 ? static_cast<Codes>(value - 10) : col);
+    }
+
+    /**
+     * @brief A 256-color foreground.
+     */
+    constexpr StyleExpr<Col256> fg(Col256 col)
+    {
+        return StyleExpr<Col256>(Col256(ColorMode::FOREGROUND, col.ID));
+    }
+
+    /**
+     * @brief A 256-color foreground with the given color ID.
+     */
+    constexpr StyleExpr<Col256> fg(int ID)
+    {
+        return StyleExpr<Col256>(Col256(ColorMode::FOREGROUND, ID));
+    }
+
+    /**
+     * @brief An RGB foreground.
+     */
+    constexpr StyleExpr<ColRGB> fg(ColRGB col)
+    {
+        return StyleExpr<ColRGB>(ColRGB(ColorMode::FOREGROUND, col.r, col.g, col.b));
+    }
+
+    /**
+     * @brief An RGB foreground with the given components.
+     */
+    constexpr StyleExpr<ColRGB> fg(int r, int g, int b)
+    {
+        return StyleExpr<ColRGB>(ColRGB(ColorMode::FOREGROUND, r, g, b));
+    }
+
+    /**
+     * @brief A 16-color background. Foreground codes are turned into the matching background code.
+     */
+    constexpr StyleExpr<Codes> bg(Codes col)
+    {
+        const int value = static_cast<int>(col);
+        return StyleExpr<Codes>(value >= 30 && value <= 39 ? static_cast<Codes>(value + 10) : col);
+    }
+
+    /**
+     * @brief A 256-color background.
+     */
+    constexpr StyleExpr<Col256> bg(Col256 col)
+    {
+        return StyleExpr<Col256>(Col256(ColorMode::BACKGROUND, col.ID));
+    }
+
+    /**
+     * @brief A 256-color background with the given color ID.
+     */
+    constexpr StyleExpr<Col256> bg(int ID)
+    {
+        return StyleExpr<Col256>(Col256(ColorMode::BACKGROUND, ID));
+    }
+
+    /**
+     * @brief An RGB background.
+     */
+    constexpr StyleExpr<ColRGB> bg(ColRGB col)
+    {
+        return StyleExpr<ColRGB>(ColRGB(ColorMode::BACKGROUND, col.r, col.g, col.b));
+    }
+
+    /**
+     * @brief An RGB background with the given components.
+     */
+    constexpr StyleExpr<ColRGB> bg(int r, int g, int b)
+    {
+        return StyleExpr<ColRGB>(ColRGB(ColorMode::BACKGROUND, r, g, b));
+    }
+
+    namespace detail
+    {
+        /**
+         * The longest parameter list of a single style, an RGB color with arbitrary `int` channels.
+        */
+        inline constexpr std::size_t max_param_length = 48;
+
+        /**
+         * Renders the styles of `expr` as one sequence, downgraded to `support`, into `out`.
+         * `out` must hold `3 + max_param_length * sizeof...(Styles)` characters.
+         *
+         * @return The length of the sequence.
+        */
+        template<typename... Styles>
+        std::size_t renderExpr(char *out, const StyleExpr<Styles...> &expr, ColorSupport support) noexcept
+        {
+            if (support == ColorSupport::NONE || sizeof...(Styles) == 0) return 0;
+            char *end = out;
+            *end++ = '\033';
+            *end++ = '[';
+            auto put = [&](const auto &style) {
+                if (end != out + 2)
+                {
+                    *end++ = ';';
+                }
+                Color col(style);
+                downgradeColor(col, support);
+                end = SgrParam<Color>::write(end, col);
+            };
+            std::apply([&](const auto &...style) { (put(style), ...); }, expr.styles);
+            *end++ = 'm';
+            return static_cast<std::size_t>(end - out);
+        }
+    } // namespace detail
+
+    /**
+     * @brief A value to be inserted into a stream with a style, returned by `styled()`.
+     *
+     * Like `std::quoted`, it only refers to the value and is meant to be inserted right away.
+     */
+    template<typename T, typename... Styles>
+    struct Styled
+    {
+        /** The value to insert. */
+        const T &value;
+        /** The style to insert it with. */
+        StyleExpr<Styles...> style;
+    };
+
+    /**
+     * Styles a value for insertion into a stream, e.g. `std::cout << styled(elapsed, fg(Codes::FOREGROUND_CYAN) | bold)`.
+     *
+     * The escape sequence is rendered on a stack buffer when inserted, and followed by a restore code. Nothing is
+     * allocated. It is rendered for the color support of the stream, detected like for a `StreamTarget`: that of the
+     * terminal for `std::cout`, `std::cerr` and `std::clog`, and none for other streams, such as files and string
+     * streams, unless `FORCE_COLOR` or `setColorSupport()` says otherwise. As an argument of formatted output,
+     * it is rendered for the color support of the target instead, and followed by a switch back to the style around it.
+     *
+     * @param value The value to insert. Anything that can be inserted into a `std::ostream`.
+     * @param style The style to insert it with.
+     * @return An object to insert into a stream.
+     */
+    template<typename T, typename... Styles>
+    constexpr Styled<T, Styles...> styled(const T &value, const StyleExpr<Styles...> &style)
+    {
+        return Styled<T, Styles...>{value, style};
+    }
+
+    template<typename T, typename... Styles>
+    std::ostream &operator<<(std::ostream &os, const Styled<T, Styles...> &styled)
+    {
+        char prefix[3 + detail::max_param_length * sizeof...(Styles)];
+        const std::size_t length = detail::renderExpr(prefix, styled.style, detail::streamColorSupport(os));
+        os.write(prefix, static_cast<std::streamsize>(length));
+        os << styled.value;
+        if (length != 0)
+        {
+            os.write("\033[0m", 4);
+        }
+        return os;
+    }
+
+    /** @} */ // end of Inline_group
+
+    /**
+     * @defgroup Format_group Formatted Output
+     * Content related to formatting arguments straight into the output buffer.
+     *
+     * With a standard library that provides `<format>`, format strings are `std::format_string` and accept
+     * every `std::format` replacement field. Otherwise a built-in formatter handles `{}` fields and the `{{` and
+     * `}}` escapes for strings, characters, booleans, numbers and `styled()` values, and checks that the number of
+     * fields matches the number of arguments. With C++20 the check is done at compile time. C++17 has no `consteval`,
+     * so a mismatched format string compiles and throws `std::invalid_argument` when it is used.
+     * @{
+    */
+
+    namespace detail
+    {
+        // Not constexpr, so that reaching one while checking a format string at compile time names the problem.
+        // Format strings checked at run time (C++17) throw instead.
+        [[noreturn]] inline void format_string_has_wrong_number_of_fields()
+        {
+            throw std::invalid_argument("termstyle: the format string does not have one {} field per argument");
+        }
+        [[noreturn]] inline void format_string_has_unsupported_field()
+        {
+            throw std::invalid_argument("termstyle: the format string has a field other than {}");
+        }
+        [[noreturn]] inline void format_string_has_unmatched_brace()
+        {
+            throw std::invalid_argument("termstyle: the format string has an unmatched }");
+        }
+
+        /**
+         * Counts the `{}` fields of a format string, reporting anything the built-in formatter does not handle.
+        */
+        constexpr std::size_t checkFormat(std::string_view fmt)
+        {
+            std::size_t fields = 0;
+            for (std::size_t i = 0; i < fmt.size(); i++)
+            {
+                if (fmt[i] == '{')
+                {
+                    if (i + 1 < fmt.size() && fmt[i + 1] == '{')
+                    {
+                        i++;
+                    }
+                    else if (i + 1 < fmt.size() && fmt[i + 1] == '}')
+                    {
+                        fields++;
+                        i++;
+                    }
+                    else
+                    {
+                        format_string_has_unsupported_field();
+                    }
+                }
+                else if (fmt[i] == '}')
+                {
+                    if (i + 1 < fmt.size() && fmt[i + 1] == '}')
+                    {
+                        i++;
+                    }
+                    else
+                    {
+                        format_string_has_unmatched_brace();
+                    }
+                }
+            }
+            return fields;
+        }
+
+        template<typename T>
+        struct Identity
+        {
+            using type = T;
+        };
+
+        /**
+         * A format string checked against its arguments when constructed: at compile time with C++20, and
+         * otherwise at run time, throwing `std::invalid_argument` if it does not match.
+        */
+        template<typename... Args>
+        class CheckedFormat
+        {
+        private:
+            std::string_view str;
+
+        public:
+            template<typename S, std::enable_if_t<std::is_convertible_v<const S &, std::string_view>, int> = 0>
+            TERMSTYLE_CONSTEVAL CheckedFormat(const S &fmt) : str(fmt)
+            {
+                if (checkFormat(str) != sizeof...(Args))
+                {
+                    format_string_has_wrong_number_of_fields();
+                }
+            }
+
+            constexpr std::string_view get() const noexcept
+            {
+                return str;
+            }
+        };
+
+        /**
+         * Where the arguments being formatted on this thread are printed: the color support of the target, or -1
+         * for that of standard output, and the state the text around them is shown in.
+        */
+        struct FormatContext
+        {
+            int support = -1;
+            SgrState around;
+
+            ColorSupport colorSupport() const noexcept
+            {
+                return support < 0 ? getColorSupport() : static_cast<ColorSupport>(support);
+            }
+        };
+
+        inline FormatContext &formatContext() noexcept
+        {
+            thread_local FormatContext context;
+            return context;
+        }
+
+        /**
+         * Sets the format context of the calling thread while it lives, e.g. around formatting the text of a preset.
+        */
+        class FormatScope
+        {
+        private:
+            FormatContext saved;
+
+        public:
+            FormatScope(ColorSupport support, const SgrState &around) noexcept : saved(formatContext())
+            {
+                formatContext() = FormatContext{static_cast<int>(support), around};
+            }
+
+            FormatScope(const FormatScope &) = delete;
+            FormatScope &operator=(const FormatScope &) = delete;
+
+            ~FormatScope()
+            {
+                formatContext() = saved;
+            }
+        };
+
+        /**
+         * Renders the end of a value styled with `style` on top of `around`: the transition back to `around`.
+        */
+        template<typename Sink, typename... Styles>
+        void renderStyledEnd(Sink &sink, const StyleExpr<Styles...> &style, ColorSupport support, const SgrState &around)
+        {
+            renderTransition(sink, downgradeState(style.state(around), support), around);
+        }
+
+        template<typename T, typename = void>
+        struct FormatArg
+        {
+            static_assert(sizeof(T) == 0, "The built-in formatter only handles strings, characters, booleans, numbers and styled() values");
+        };
+
+        template<>
+        struct FormatArg<bool>
+        {
+            static void append(std::string &out, bool value)
+            {
+                out.append(value ? "true" : "false");
+            }
+        };
+
+        template<>
+        struct FormatArg<char>
+        {
+            static void append(std::string &out, char value)
+            {
+                out.push_back(value);
+            }
+        };
+
+        template<typename T>
+        struct FormatArg<T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>>>
+        {
+            static void append(std::string &out, T value)
+            {
+                char buf[64];
+                const std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), value);
+                out.append(buf, static_cast<std::size_t>(res.ptr - buf));
+            }
+        };
+
+        template<typename T>
+        struct FormatArg<T, std::enable_if_t<std::is_convertible_v<const T &, std::string_view>>>
+        {
+            static void append(std::string &out, const T &value)
+            {
+                const std::string_view str = value;
+                out.append(str.data(), str.size());
+            }
+        };
+
+        template<typename T, typename... Styles>
+        struct FormatArg<Styled<T, Styles...>>
+        {
+            static void append(std::string &out, const Styled<T, Styles...> &value)
+            {
+                const FormatContext &context = formatContext();
+                const ColorSupport support = context.colorSupport();
+                char prefix[3 + max_param_length * sizeof...(Styles)];
+                const std::size_t length = renderExpr(prefix, value.style, support);
+                out.append(prefix, length);
+                FormatArg<std::remove_cv_t<T>>::append(out, value.value);
+                if (length != 0)
+                {
+                    StringSink sink{out};
+                    renderStyledEnd(sink, value.style, support, context.around);
+                }
+            }
+        };
+
+        template<typename T>
+        void appendErased(std::string &out, const void *value)
+        {
+            using Value = std::remove_reference_t<T>;
+            FormatArg<std::remove_cv_t<Value>>::append(out, *static_cast<const Value *>(value));
+        }
+
+        /**
+         * Appends `fmt` with each `{}` field replaced by the next argument.
+        */
+        template<typename... Args>
+        void vformatTo(std::string &out, std::string_view fmt, const Args &...args)
+        {
+            using Appender = void (*)(std::string &, const void *);
+            const Appender appenders[] = {&appendErased<Args>..., nullptr};
+            const void *values[] = {static_cast<const void *>(&args)..., nullptr};
+            std::size_t next = 0;
+            std::size_t i = 0;
+            while (i < fmt.size())
+            {
+                const std::size_t brace = fmt.find_first_of("{}", i);
+                if (brace == std::string_view::npos)
+                {
+                    out.append(fmt.data() + i, fmt.size() - i);
+                    break;
+                }
+                out.append(fmt.data() + i, brace - i);
+                const char c = fmt[brace];
+                const char following = brace + 1 < fmt.size() ? fmt[brace + 1] : '\0';
+                if (c == '{' && following == '}')
+                {
+                    if (next < sizeof...(Args))
+                    {
+                        appenders[next](out, values[next]);
+                        next++;
+                    }
+                }
+                else if (following == c)
+                {
+                    out.push_back(c);
+                }
+                else
+                {
+                    // A lone brace, only possible without compile-time checking. Kept as it is.
+                    out.push_back(c);
+                    i = brace + 1;
+                    continue;
+                }
+                i = brace + 2;
+            }
+        }
+    } // namespace detail
+
+#if defined(__cpp_lib_format)
+    /**
+     * @brief A format string checked at compile time against the types of its arguments.
+     */
+    template<typename... Args>
+    using FormatString = std::format_string<Args...>;
+
+    namespace detail
+    {
+        template<typename... Args>
+        void formatTo(std::string &out, FormatString<Args...> fmt, Args &&...args)
+        {
+            std::format_to(std::back_inserter(out), fmt, std::forward<Args>(args)...);
+        }
+
+        /**
+         * The type whose `std::formatter` formats a styled value. Character arrays are formatted as C strings.
+        */
+        template<typename T>
+        using FormatValue = std::conditional_t<std::is_array_v<T>, const std::remove_extent_t<T> *, std::remove_cv_t<T>>;
+    } // namespace detail
+#else
+    /**
+     * @brief A format string checked at compile time against the number of its arguments.
+     *
+     * The check needs C++20. With C++17 a mismatched format string compiles, and throws
+     * `std::invalid_argument` when it is used.
+     */
+    template<typename... Args>
+    using FormatString = detail::CheckedFormat<typename detail::Identity<Args>::type...>;
+
+    namespace detail
+    {
+        template<typename... Args>
+        void formatTo(std::string &out, FormatString<Args...> fmt, Args &&...args)
+        {
+            vformatTo(out, fmt.get(), args...);
+        }
+    } // namespace detail
+#endif
+
+    /**
+     * Appends the formatted arguments to `out`, e.g. `append_format(line, "took {}ms", elapsed)`.
+     *
+     * @param out  The string to append to. It only allocates if its capacity is exceeded.
+     * @param fmt  The format string.
+     * @param args The arguments to format.
+     */
+    template<typename... Args>
+    void append_format(std::string &out, FormatString<Args...> fmt, Args &&...args)
+    {
+        detail::formatTo<Args...>(out, fmt, std::forward<Args>(args)...);
+    }
+
+    /** @} */ // end of Format_group
+
+    /**
+     * @defgroup Text_group Styled Text
+     * Content related to rendering many differently styled segments at once.
+     * @{
+    */
+
+    /**
+     * @brief A line of text made of differently styled spans over a single buffer.
+     *
+     * Where printing a status line with a preset per field looks up and writes every field separately,
+     * a `StyledText` collects the fields first and renders the whole line in one pass, switching only the
+     * attributes that change between spans, so it can be written with a single call.
+     *
+     * Colors are downgraded to the current `ColorSupport` when appended. Call `clear()` to reuse the buffers
+     * for the next redraw without allocating.
+     */
+    class StyledText
+    {
+    public:
+        /**
+         * @brief A run of text displayed in one style.
+        */
+        struct Span
+        {
+            /** The offset of the run in `text()`. */
+            std::size_t offset;
+            /** The length of the run. */
+            std::size_t length;
+            /** The style the run is displayed in. */
+            SgrState style;
+        };
+
+    private:
+        std::string buffer;
+        std::vector<Span> runs;
+
+    public:
+        /**
+         * @brief Appends text in the terminal's default style.
+         */
+        StyledText &append(std::string_view text)
+        {
+            return append(text, SgrState());
+        }
+
+        /**
+         * @brief Appends text displayed in the given state. Adjacent text in the same style shares a span.
+         */
+        StyledText &append(std::string_view text, const SgrState &style)
+        {
+            if (text.empty()) return *this;
+            const SgrState shown = detail::downgradeState(style, getColorSupport());
+            if (!runs.empty() && runs.back().style == shown)
+            {
+                runs.back().length += text.size();
+            }
+            else
+            {
+                runs.push_back(Span{buffer.size(), text.size(), shown});
+            }
+            buffer.append(text.data(), text.size());
+            return *this;
+        }
+
+        /**
+         * @brief Appends text styled with the given colors, applied to the terminal's default style.
+         */
+        StyledText &append(std::string_view text, const StyleList<Color> &styles)
+        {
+            SgrState style;
+            style.apply(styles);
+            return append(text, style);
+        }
+
+        /**
+         * @brief Appends text styled with a style expression, applied to the terminal's default style.
+         */
+        template<typename... Styles>
+        StyledText &append(std::string_view text, const StyleExpr<Styles...> &style)
+        {
+            return append(text, style.state());
+        }
+
+        /**
+         * @brief Removes all text and spans, keeping the allocated buffers.
+         */
+        void clear() noexcept
+        {
+            buffer.clear();
+            runs.clear();
+        }
+
+        /**
+         * @return The text without escape sequences.
+        */
+        std::string_view text() const noexcept
+        {
+            return buffer;
+        }
+
+        /**
+         * @return The spans covering `text()`, in order.
+        */
+        const std::vector<Span> &spans() const noexcept
+        {
+            return runs;
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * Renders every span with the minimal transition from the previous one, ending in the default state.
+        */
+        template<typename Sink>
+        void renderStyle(Sink &sink, const StyledText &text)
+        {
+            const std::string_view str = text.text();
+            SgrState current;
+            for (const StyledText::Span &span : text.spans())
+            {
+                renderTransition(sink, current, span.style);
+                current = span.style;
+                sink.put(str.data() + span.offset, span.length);
+            }
+            renderTransition(sink, current, SgrState());
+        }
+
+        /**
+         * Renders `text` for a target with the given color support, which may be lower than the one
+         * the text was styled for.
+        */
+        template<typename Sink>
+        void renderStyle(Sink &sink, const StyledText &text, ColorSupport support)
+        {
+            if (support == ColorSupport::COLRGB)
+            {
+                renderStyle(sink, text);
+                return;
+            }
+            const std::string_view str = text.text();
+            SgrState current;
+            for (const StyledText::Span &span : text.spans())
+            {
+                const SgrState shown = downgradeState(span.style, support);
+                renderTransition(sink, current, shown);
+                current = shown;
+                sink.put(str.data() + span.offset, span.length);
+            }
+            renderTransition(sink, current, SgrState());
+        }
+    } // namespace detail
+
+    /**
+     * Appends `text` with its escape sequences to `out`.
+     *
+     * @param out The string to append to. It only allocates if its capacity is exceeded.
+     * @param text The styled text to render.
+     */
+    inline void append_to(std::string &out, const StyledText &text)
+    {
+        detail::StringSink sink{out};
+        detail::renderStyle(sink, text);
+    }
+
+    /**
+     * Renders `text` with its escape sequences into a fixed buffer.
+     *
+     * @param out The buffer to write to.
+     * @param cap The size of the buffer.
+     * @param text The styled text to render.
+     * @return The full length of the rendered text. Only the first `cap` characters are written.
+     */
+    inline std::size_t render_to(char *out, std::size_t cap, const StyledText &text) noexcept
+    {
+        detail::BufferSink sink{out, cap};
+        detail::renderStyle(sink, text);
+        return sink.size;
+    }
+
+    /** @} */ // end of Text_group
+
+    /**
+     * @defgroup Strip_group Stripping Styles
+     * @brief Functions for removing escape sequences from styled output and measuring what remains visible.
+     * @{
+     */
+
+    namespace detail
+    {
+        /**
+         * Index of the lowest set bit of a non-zero mask.
+        */
+        inline unsigned lowestBit(std::uint32_t mask) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        inline unsigned countBits(std::uint32_t mask) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned count = 0;
+            for (; mask; mask &= mask - 1) count++;
+            return count;
+#else
+            return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+        }
+
+        /**
+         * Finds the first ESC byte in [first, last), or returns `last`.
+         * Compares 32 or 16 bytes at a time when AVX2 or SSE2 is enabled at compile time;
+         * the tail and other architectures fall back to `memchr()`.
+        */
+        inline const char *findEscape(const char *first, const char *last) noexcept
+        {
+#if defined(TERMSTYLE_AVX2)
+            const __m256i esc32 = _mm256_set1_epi8('\033');
+            for (; last - first >= 32; first += 32)
+            {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, esc32)));
+                if (mask != 0) return first + lowestBit(mask);
+            }
+#endif
+#if defined(TERMSTYLE_SSE2)
+            const __m128i esc16 = _mm_set1_epi8('\033');
+            for (; last - first >= 16; first += 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, esc16)));
+                if (mask != 0) return first + lowestBit(mask);
+            }
+#endif
+            if (first == last) return last;
+            const void *found = std::memchr(first, '\033', static_cast<std::size_t>(last - first));
+            return found ? static_cast<const char *>(found) : last;
+        }
+
+        /**
+         * Returns the end of the SGR sequence `first` points at, or `first` if it does not start a complete one.
+        */
+        inline const char *skipSgr(const char *first, const char *last) noexcept
+        {
+            if (last - first < 3 || first[1] != '[') return first;
+            const char *pos = first + 2;
+            while (pos != last && ((*pos >= '0' && *pos <= '9') || *pos == ';' || *pos == ':')) pos++;
+            return pos != last && *pos == 'm' ? pos + 1 : first;
+        }
+
+        /**
+         * Calls `visit(data, length)` for every run of text between SGR sequences, in order.
+         * Runs never overlap the bytes that follow them, so `visit` may move them to an earlier position.
+        */
+        template<typename Visit>
+        void forEachVisibleRun(const char *first, const char *last, Visit &&visit)
+        {
+            const char *run = first;
+            while (first != last)
+            {
+                const char *esc = findEscape(first, last);
+                if (esc == last) break;
+                const char *next = skipSgr(esc, last);
+                if (next == esc)
+                {
+                    first = esc + 1;
+                    continue;
+                }
+                if (esc != run) visit(run, static_cast<std::size_t>(esc - run));
+                run = first = next;
+            }
+            if (last != run) visit(run, static_cast<std::size_t>(last - run));
+        }
+
+        /**
+         * Adds the UTF-8 code points before the first ESC byte in [first, last) to `count`
+         * and returns the position of that byte, or `last`.
+         * Code points are counted as the bytes that are not continuation bytes, in the same pass as the search.
+         * Full chunks sum their continuation bytes with `psadbw`; only the chunk holding the ESC counts bits.
+        */
+        inline const char *countUntilEscape(const char *first, const char *last, std::size_t &count) noexcept
+        {
+            std::size_t continuations = 0;
+            const char *start = first;
+#if defined(TERMSTYLE_AVX2)
+            if (last - first >= 32)
+            {
+                const __m256i esc32 = _mm256_set1_epi8('\033');
+                const __m256i high32 = _mm256_set1_epi8(static_cast<char>(0xC0));
+                const __m256i cont32 = _mm256_set1_epi8(static_cast<char>(0x80));
+                const __m256i one32 = _mm256_set1_epi8(1);
+                __m256i sums = _mm256_setzero_si256();
+                for (; last - first >= 32; first += 32)
+                {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                    const __m256i is_cont = _mm256_cmpeq_epi8(_mm256_and_si256(chunk, high32), cont32);
+                    const auto esc = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, esc32)));
+                    if (esc != 0)
+                    {
+                        const unsigned index = lowestBit(esc);
+                        const auto cont = static_cast<std::uint32_t>(_mm256_movemask_epi8(is_cont));
+                        continuations += countBits(cont & ((std::uint32_t{1} << index) - 1));
+                        first += index;
+                        break;
+                    }
+                    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_and_si256(is_cont, one32), _mm256_setzero_si256()));
+                }
+                alignas(32) std::uint64_t lanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sums);
+                continuations += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+                if (first != last && *first == '\033')
+                {
+                    count += static_cast<std::size_t>(first - start) - continuations;
+                    return first;
+                }
+            }
+#endif
+#if defined(TERMSTYLE_SSE2)
+            if (last - first >= 16)
+            {
+                const __m128i esc16 = _mm_set1_epi8('\033');
+                const __m128i high16 = _mm_set1_epi8(static_cast<char>(0xC0));
+                const __m128i cont16 = _mm_set1_epi8(static_cast<char>(0x80));
+                const __m128i one16 = _mm_set1_epi8(1);
+                __m128i sums = _mm_setzero_si128();
+                for (; last - first >= 16; first += 16)
+                {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                    const __m128i is_cont = _mm_cmpeq_epi8(_mm_and_si128(chunk, high16), cont16);
+                    const auto esc = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, esc16)));
+                    if (esc != 0)
+                    {
+                        const unsigned index = lowestBit(esc);
+                        const auto cont = static_cast<std::uint32_t>(_mm_movemask_epi8(is_cont));
+                        continuations += countBits(cont & ((std::uint32_t{1} << index) - 1));
+                        first += index;
+                        break;
+                    }
+                    sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_and_si128(is_cont, one16), _mm_setzero_si128()));
+                }
+                alignas(16) std::uint64_t lanes[2];
+                _mm_store_si128(reinterpret_cast<__m128i *>(lanes), sums);
+                continuations += static_cast<std::size_t>(lanes[0] + lanes[1]);
+                if (first != last && *first == '\033')
+                {
+                    count += static_cast<std::size_t>(first - start) - continuations;
+                    return first;
+                }
+            }
+#endif
+            for (; first != last && *first != '\033'; first++)
+            {
+                continuations += (static_cast<unsigned char>(*first) & 0xC0) == 0x80;
+            }
+            count += static_cast<std::size_t>(first - start) - continuations;
+            return first;
+        }
+    } // namespace detail
+
+    /**
+     * Removes every SGR sequence (`ESC [ params m`) from a buffer in place, without allocating.
+     *
+     * Other control sequences, a lone ESC and a sequence cut off at the end are kept as they are.
+     *
+     * @param data The buffer to strip.
+     * @param length The length of the buffer.
+     * @return The new length of the buffer. For a `std::string`, use `str.resize(strip_styles(str.data(), str.size()))`.
+     */
+    inline std::size_t strip_styles(char *data, std::size_t length) noexcept
+    {
+        char *out = data;
+        detail::forEachVisibleRun(data, data + length, [&out](const char *run, std::size_t size) {
+            if (out != run) std::memmove(out, run, size);
+            out += size;
+        });
+        return static_cast<std::size_t>(out - data);
+    }
+
+    /**
+     * Returns a copy of `text` without its SGR sequences.
+     *
+     * @param text The styled text, for example captured output of this library.
+     * @return The text as it is displayed, without styles.
+     */
+    inline std::string strip_styles(std::string_view text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        detail::forEachVisibleRun(text.data(), text.data() + text.size(), [&result](const char *run, std::size_t size) {
+            result.append(run, size);
+        });
+        return result;
+    }
+
+    /**
+     * Counts the characters of `text` that are displayed, skipping SGR sequences without allocating.
+     *
+     * Characters are UTF-8 code points. Wide and combining characters are not accounted for,
+     * so the result is the column count only for text in narrow scripts.
+     *
+     * @param text The styled text to measure.
+     * @return The number of visible characters.
+     */
+    inline std::size_t visible_width(std::string_view text) noexcept
+    {
+        const char *first = text.data();
+        const char *last = first + text.size();
+        std::size_t width = 0;
+        while (first != last)
+        {
+            const char *esc = detail::countUntilEscape(first, last, width);
+            if (esc == last) break;
+            first = detail::skipSgr(esc, last);
+            if (first == esc)
+            {
+                width++;
+                first++;
+            }
+        }
+        return width;
+    }
+
+    /** @} */ // end of Strip_group
+
+    /**
+     * @defgroup Decode_group Decoding Styles
+     * @brief Content related to reading styled output back into `SgrState`s.
+     * @{
+     */
+
+    /**
+     * @brief An incremental decoder that turns styled output back into runs of text and the style they are shown in.
+     *
+     * Output can be fed in chunks of any size, and escape sequences split between chunks are decoded as if
+     * they were whole. The decoder never allocates: text is passed on as views into the chunk, and the
+     * parameters of a sequence are applied to a copy of the state as they arrive, which only replaces the
+     * state when the sequence ends in `m`.
+     *
+     * SGR sequences with `Codes`, `38;5;n` / `48;5;n` (`Col256`) and `38;2;r;g;b` / `48;2;r;g;b` (`ColRGB`) parameters
+     * change the state. The ITU forms with colon-separated subparameters, `38:5:n` and `38:2:[id]:r:g:b` (with or
+     * without the color space ID), are decoded as one parameter each, and other parameters with subparameters, like
+     * `4:3`, are ignored. Other control sequences are consumed without any effect, and an ESC that does not start
+     * a control sequence is passed on as text.
+     *
+     * @code
+     * ts::SgrDecoder decoder;
+     * while (read(fd, buf, sizeof(buf)) > 0)
+     *     decoder.feed({buf, n}, [](std::string_view text, const ts::SgrState &state) { ... });
+     * @endcode
+     */
+    class SgrDecoder
+    {
+    private:
+        enum class Mode : std::uint8_t
+        {
+            TEXT,
+            ESCAPE,
+            CSI
+        };
+
+        SgrState current;
+        /** The state with the parameters of the sequence being read applied. */
+        SgrState next;
+        Mode mode = Mode::TEXT;
+        /** Set when the sequence being read is not SGR, e.g. it has a private marker or intermediate bytes. */
+        bool other = false;
+        /** How far into an extended color: 1 after 38 or 48, 5 for a 256-color ID, 2 to 4 for RGB channels. */
+        std::uint8_t extended = 0;
+        ColorMode extended_mode = ColorMode::FOREGROUND;
+        int value = 0;
+        int channels[3] = {};
+        /** The subparameters of the parameter being read before its last one, when it has colons. */
+        int subparams[5] = {};
+        std::uint8_t subparam_count = 0;
+
+        /**
+         * Applies a parameter with colon-separated subparameters, e.g. `38:2::255:0:0`, as a whole.
+        */
+        void endGroup(int last) noexcept
+        {
+            const std::size_t count = subparam_count;
+            subparam_count = 0;
+            // Parameters split by semicolons before it are not continued by it.
+            extended = 0;
+            if (count > 5 || (subparams[0] != 38 && subparams[0] != 48)) return;
+            const ColorMode mode = static_cast<ColorMode>(subparams[0]);
+            if (count == 2 && subparams[1] == 5)
+            {
+                if (validateColorID(last)) next.apply(Col256(mode, last));
+            }
+            else if ((count == 4 || count == 5) && subparams[1] == 2)
+            {
+                // The color space ID is optional: 38:2:r:g:b, or 38:2:id:r:g:b with an ID that is usually empty.
+                const int *rgb = subparams + count - 2;
+                next.apply(ColRGB(mode, rgb[0], rgb[1], last));
+            }
+        }
+
+        void endParam() noexcept
+        {
+            const int param = value;
+            value = 0;
+            if (subparam_count != 0)
+            {
+                endGroup(param);
+            }
+            else if (extended == 0)
+            {
+                if (param == 38 || param == 48)
+                {
+                    extended = 1;
+                    extended_mode = static_cast<ColorMode>(param);
+                }
+                else
+                {
+                    next.apply(static_cast<Codes>(param));
+                }
+            }
+            else if (extended == 1)
+            {
+                extended = param == 5 ? 5 : (param == 2 ? 2 : 0);
+            }
+            else if (extended == 5)
+            {
+                if (validateColorID(param)) next.apply(Col256(extended_mode, param));
+                extended = 0;
+            }
+            else
+            {
+                channels[extended - 2] = param;
+                if (++extended == 5)
+                {
+                    next.apply(ColRGB(extended_mode, channels[0], channels[1], channels[2]));
+                    extended = 0;
+                }
+            }
+        }
+
+        /**
+         * Reads one byte of a control sequence. Returns false if the byte ends it without belonging to it.
+        */
+        bool readCsi(char c) noexcept
+        {
+            if (c >= '0' && c <= '9')
+            {
+                // Larger values are invalid anyway, and this keeps them from overflowing.
+                value = std::min(value * 10 + (c - '0'), 99999);
+            }
+            else if (c == ';')
+            {
+                endParam();
+            }
+            else if (c == ':')
+            {
+                if (subparam_count < 5) subparams[subparam_count] = value;
+                subparam_count = static_cast<std::uint8_t>(std::min(subparam_count + 1, 6));
+                value = 0;
+            }
+            else if ((c >= 0x20 && c <= 0x2F) || (c >= 0x3C && c <= 0x3F))
+            {
+                other = true;
+            }
+            else if (c >= 0x40 && c <= 0x7E)
+            {
+                if (c == 'm' && !other)
+                {
+                    endParam();
+                    current = next;
+                }
+                mode = Mode::TEXT;
+            }
+            else
+            {
+                mode = Mode::TEXT;
+                return false;
+            }
+            return true;
+        }
+
+    public:
+        /**
+         * @brief Decodes the next chunk of output.
+         *
+         * @param chunk The bytes to decode. Text is passed on as views into it, so it only has to live during the call.
+         * @param on_text Called as `on_text(std::string_view text, const SgrState &state)` for every run of text
+         *                shown in the same state. Runs are never empty, but adjacent runs may share a state.
+         */
+        template<typename Handler>
+        void feed(std::string_view chunk, Handler &&on_text)
+        {
+            const char *pos = chunk.data();
+            const char *const last = pos + chunk.size();
+            while (pos != last)
+            {
+                if (mode == Mode::TEXT)
+                {
+                    const char *esc = detail::findEscape(pos, last);
+                    if (esc != pos) on_text(std::string_view(pos, static_cast<std::size_t>(esc - pos)), current);
+                    if (esc == last) return;
+                    mode = Mode::ESCAPE;
+                    pos = esc + 1;
+                }
+                else if (mode == Mode::ESCAPE)
+                {
+                    if (*pos == '[')
+                    {
+                        mode = Mode::CSI;
+                        next = current;
+                        other = false;
+                        extended = 0;
+                        subparam_count = 0;
+                        value = 0;
+                        pos++;
+                    }
+                    else
+                    {
+                        mode = Mode::TEXT;
+                        on_text(std::string_view("\033", 1), current);
+                    }
+                }
+                else
+                {
+                    for (; pos != last && mode == Mode::CSI; pos++)
+                    {
+                        if (!readCsi(*pos)) break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the state after everything decoded so far.
+         */
+        const SgrState &state() const noexcept
+        {
+            return current;
+        }
+
+        /**
+         * @return Whether the last chunk ended inside an escape sequence.
+        */
+        bool pending() const noexcept
+        {
+            return mode != Mode::TEXT;
+        }
+
+        /**
+         * @brief Forgets the state and any unfinished sequence, e.g. before decoding another stream.
+         */
+        void reset() noexcept
+        {
+            current = SgrState();
+            mode = Mode::TEXT;
+        }
+    };
+
+    /** @} */ // end of Decode_group
+
+    /**
+     * @defgroup Gradient_group Gradients
+     * @brief Content related to coloring text one character at a time along a gradient.
+     * @{
+     */
+
+    namespace detail
+    {
+        /**
+         * A color in the OKLab space, where equal distances look equally different.
+         * @see https://bottosson.github.io/posts/oklab/
+        */
+        struct OkLab
+        {
+            double L, a, b;
+        };
+
+        inline double srgbToLinear(int channel) noexcept
+        {
+            const double c = clampChannel(channel) / 255.0;
+            return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+        }
+
+        inline int linearToSrgb(double c) noexcept
+        {
+            c = std::min(std::max(c, 0.0), 1.0);
+            const double v = c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1 / 2.4) - 0.055;
+            return static_cast<int>(v * 255 + 0.5);
+        }
+
+        inline OkLab toOkLab(const ColRGB &col) noexcept
+        {
+            const double r = srgbToLinear(col.r), g = srgbToLinear(col.g), b = srgbToLinear(col.b);
+            const double l = std::cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+            const double m = std::cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+            const double s = std::cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+            return {0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s,
+                    1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s,
+                    0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s};
+        }
+
+        inline ColRGB fromOkLab(const OkLab &lab, ColorMode mode) noexcept
+        {
+            double l = lab.L + 0.3963377774 * lab.a + 0.2158037573 * lab.b;
+            double m = lab.L - 0.1055613458 * lab.a - 0.0638541728 * lab.b;
+            double s = lab.L - 0.0894841775 * lab.a - 1.2914855480 * lab.b;
+            l = l * l * l;
+            m = m * m * m;
+            s = s * s * s;
+            return ColRGB(mode, linearToSrgb(4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s),
+                          linearToSrgb(-1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s),
+                          linearToSrgb(-0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s));
+        }
+
+        /**
+         * One sample of a gradient, with its escape sequence already rendered for every color support.
+         * Index 0 is `COL16`, 1 is `COL256` and 2 is `COLRGB`.
+        */
+        struct GradientEntry
+        {
+            std::uint8_t r, g, b;
+            /** Equal for two samples that render the same sequence. */
+            std::uint32_t key[3];
+            std::uint8_t length[3];
+            /** Long enough for `\033[48;2;255;255;255m`, so that copies can have a fixed size. */
+            char sgr[3][20];
+        };
+    } // namespace detail
+
+    /**
+     * @brief Class for coloring text along a gradient through evenly spaced color stops.
+     *
+     * Colors are interpolated in the OKLab space, so that the gradient changes evenly to the eye
+     * and passes through no muddy grays. A table of 256 samples is built once, with the escape
+     * sequence of every sample rendered and quantized for each color support, so rendering only
+     * picks a sample per character and copies its sequence. Adjacent characters that quantize to
+     * the same color share one sequence.
+     *
+     * @code
+     * const ts::Gradient heat{ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 0, 255),
+     *                         ts::ColRGB(ts::ColorMode::BACKGROUND, 255, 0, 0)};
+     * ts::print(heat, std::string(200, ' '));
+     * @endcode
+     */
+    class Gradient
+    {
+    public:
+        /**
+         * The number of samples in the table. Text wider than this repeats samples.
+         */
+        static constexpr std::size_t resolution = 256;
+
+        /**
+         * @brief Constructs a gradient through `stops`, using the color mode of the first one.
+         *
+         * @param stops The colors, spread evenly from the first to the last character.
+         *              Without stops, text is rendered unstyled.
+         */
+        explicit Gradient(const std::vector<ColRGB> &stops) : color_mode(stops.empty() ? ColorMode::FOREGROUND : stops[0].mode)
+        {
+            if (stops.empty()) return;
+            std::vector<detail::OkLab> labs;
+            labs.reserve(stops.size());
+            for (const ColRGB &stop : stops)
+            {
+                labs.push_back(detail::toOkLab(stop));
+            }
+            entries.resize(resolution);
+            for (std::size_t i = 0; i < resolution; i++)
+            {
+                const double t = static_cast<double>(i) * static_cast<double>(labs.size() - 1) / (resolution - 1);
+                const std::size_t k = std::min(static_cast<std::size_t>(t), labs.size() > 1 ? labs.size() - 2 : 0);
+                const double f = labs.size() > 1 ? t - static_cast<double>(k) : 0;
+                const detail::OkLab &from = labs[k], &to = labs[std::min(k + 1, labs.size() - 1)];
+                fill(entries[i], detail::fromOkLab({from.L + (to.L - from.L) * f, from.a + (to.a - from.a) * f,
+                                                    from.b + (to.b - from.b) * f}, color_mode));
+            }
+        }
+
+        Gradient(std::initializer_list<ColRGB> stops) : Gradient(std::vector<ColRGB>(stops)) {}
+
+        /**
+         * @brief Constructs a gradient through `Col256` stops, interpolating between their palette colors.
+         */
+        Gradient(std::initializer_list<Col256> stops) : Gradient(toColRGB(stops)) {}
+
+        /**
+         * @brief Returns the color of a character.
+         *
+         * @param cell The index of the character.
+         * @param width The number of characters the gradient is spread over.
+         * @return The sampled color, or black if the gradient has no stops.
+         */
+        ColRGB at(std::size_t cell, std::size_t width) const noexcept
+        {
+            if (entries.empty()) return ColRGB(color_mode, 0, 0, 0);
+            const detail::GradientEntry &e = entry(cell, width);
+            return ColRGB(color_mode, e.r, e.g, e.b);
+        }
+
+        ColorMode mode() const noexcept
+        {
+            return color_mode;
+        }
+
+        bool empty() const noexcept
+        {
+            return entries.empty();
+        }
+
+        /**
+         * Renders `text` with every UTF-8 character in the color of its position, followed by the
+         * foreground or background reset, in one pass through `sink`.
+        */
+        template<typename Sink>
+        void render(Sink &sink, std::string_view text, ColorSupport support) const
+        {
+            if (entries.empty() || support == ColorSupport::NONE)
+            {
+                detail::renderText(sink, text);
+                return;
+            }
+            const int level = static_cast<int>(support) - 1;
+            std::size_t width = 0;
+            for (char c : text)
+            {
+                width += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+            }
+
+            char buf[512];
+            std::size_t used = 0;
+            std::uint32_t last_key = ~std::uint32_t{0};
+            const std::uint64_t step = sampleStep(width);
+            std::uint64_t position = std::uint64_t{1} << 31;
+            for (std::size_t i = 0; i < text.size(); position += step)
+            {
+                std::size_t next = i + 1;
+                while (next < text.size() && (static_cast<unsigned char>(text[next]) & 0xC0) == 0x80) next++;
+                const detail::GradientEntry &e = entries[position >> 32];
+                if (used + sizeof(e.sgr[0]) + 4 > sizeof(buf))
+                {
+                    sink.put(buf, used);
+                    used = 0;
+                }
+                if (e.key[level] != last_key)
+                {
+                    last_key = e.key[level];
+                    std::memcpy(buf + used, e.sgr[level], sizeof(e.sgr[level]));
+                    used += e.length[level];
+                }
+                if (next - i <= 4)
+                {
+                    std::memcpy(buf + used, text.data() + i, next - i);
+                    used += next - i;
+                }
+                else
+                {
+                    sink.put(buf, used);
+                    sink.put(text.data() + i, next - i);
+                    used = 0;
+                }
+                i = next;
+            }
+            if (used + 5 > sizeof(buf))
+            {
+                sink.put(buf, used);
+                used = 0;
+            }
+            if (width != 0)
+            {
+                std::memcpy(buf + used, color_mode == ColorMode::FOREGROUND ? "\033[39m" : "\033[49m", 5);
+                used += 5;
+            }
+            sink.put(buf, used);
+        }
+
+    private:
+        std::vector<detail::GradientEntry> entries;
+        ColorMode color_mode;
+
+        static std::vector<ColRGB> toColRGB(std::initializer_list<Col256> stops)
+        {
+            std::vector<ColRGB> colors;
+            colors.reserve(stops.size());
+            for (const Col256 &stop : stops)
+            {
+                colors.push_back(termstyle::toColRGB(stop));
+            }
+            return colors;
+        }
+
+        static void fill(detail::GradientEntry &e, const ColRGB &col) noexcept
+        {
+            e.r = static_cast<std::uint8_t>(col.r);
+            e.g = static_cast<std::uint8_t>(col.g);
+            e.b = static_cast<std::uint8_t>(col.b);
+            const Col256 col256(col.mode, detail::nearest256(col.r, col.g, col.b));
+            const Codes code = detail::codesFor(detail::nearest16(col.r, col.g, col.b), col.mode);
+            e.key[0] = static_cast<std::uint32_t>(code);
+            e.key[1] = static_cast<std::uint32_t>(col256.ID);
+            e.key[2] = static_cast<std::uint32_t>(col.r) << 16 | static_cast<std::uint32_t>(col.g) << 8
+                       | static_cast<std::uint32_t>(col.b);
+            detail::BufferSink sinks[3] = {{e.sgr[0], sizeof(e.sgr[0])}, {e.sgr[1], sizeof(e.sgr[1])},
+                                           {e.sgr[2], sizeof(e.sgr[2])}};
+            detail::renderSgr(sinks[0], code);
+            detail::renderSgr(sinks[1], col256);
+            detail::renderSgr(sinks[2], col);
+            for (int level = 0; level < 3; level++)
+            {
+                e.length[level] = static_cast<std::uint8_t>(sinks[level].size);
+            }
+        }
+
+        /**
+         * The distance between the samples of adjacent characters as a 32.32 fixed-point number,
+         * so that rendering steps through the table without a division per character.
+        */
+        static std::uint64_t sampleStep(std::size_t width) noexcept
+        {
+            return width > 1 ? (std::uint64_t{resolution - 1} << 32) / (width - 1) : 0;
+        }
+
+        const detail::GradientEntry &entry(std::size_t cell, std::size_t width) const noexcept
+        {
+            const std::size_t last = width > 1 ? width - 1 : 0;
+            return entries[(std::min(cell, last) * sampleStep(width) + (std::uint64_t{1} << 31)) >> 32];
+        }
+    };
+
+    /**
+     * Appends `text` colored along `gradient` to `out`.
+     *
+     * @param out The string to append to. It only allocates if its capacity is exceeded.
+     * @param gradient The gradient to color the characters with.
+     * @param text The text to color.
+     */
+    inline void append_to(std::string &out, const Gradient &gradient, std::string_view text)
+    {
+        detail::StringSink sink{out};
+        gradient.render(sink, text, getColorSupport());
+    }
+
+    /**
+     * Renders `text` colored along `gradient` into a fixed buffer. Never allocates.
+     *
+     * @param out The buffer to write to. It is not null-terminated.
+     * @param cap The capacity of `out`. If the result is longer, only the first `cap` bytes are written.
+     * @param gradient The gradient to color the characters with.
+     * @param text The text to color.
+     * @return The full length of the result, which may exceed `cap`.
+     */
+    inline std::size_t render_to(char *out, std::size_t cap, const Gradient &gradient, std::string_view text) noexcept
+    {
+        detail::BufferSink sink{out, cap};
+        gradient.render(sink, text, getColorSupport());
+        return sink.size;
+    }
+
+    /** @} */ // end of Gradient_group
+
+    /**
+     * @defgroup Markup_group Markup
+     * Content related to styling text with inline markup, e.g. `"[bold red]ERROR[/] took [cyan]{}ms[/]"`.
+     *
+     * A tag in square brackets applies styles until the matching `[/]`, which restores the styles before the tag.
+     * Tags hold any number of these words, separated by spaces:
+     * - attributes: `bold` (`b`), `dim`, `italic` (`i`), `underline` (`u`), `flash` (`blink`), `reverse`, `hidden`, `strike` (`s`);
+     * - 16 colors: `black`, `red`, `green`, `yellow`, `blue`, `purple` (`magenta`), `cyan`, `white` and `default`;
+     * - 256 colors: `color(28)`;
+     * - RGB colors: `#ff8800`.
+     *
+     * A color after `on` is a background color, e.g. `[white on color(17)]`. A bracketed text with any other word,
+     * like `[INFO]`, is not a tag and is kept as it is. `[[` and `]]` are literal brackets. `{}` fields are replaced
+     * by the arguments like with `append_format()`, by the built-in formatter, and `{{` and `}}` are literal braces.
+     *
+     * A template is compiled once per thread and color support into its escape sequences, so rendering it again only
+     * copies the compiled bytes and formats the arguments in between. Each thread keeps the `detail::markup_cache_size`
+     * most recently used templates, looked up by their contents, so templates built at run time do not grow the cache.
+     * @{
+    */
+
+    namespace detail
+    {
+        /**
+         * A markup template compiled for one color support: the text and escape sequences to copy,
+         * and the offsets in them where the arguments go.
+        */
+        struct CompiledMarkup
+        {
+            std::string source;
+            std::size_t hash = 0;
+            int support = -1;
+            std::uint64_t used = 0;
+            std::string bytes;
+            std::vector<std::size_t> fields;
+            /** The state each field is shown in, which styled arguments switch back to. */
+            std::vector<SgrState> field_states;
+        };
+
+        /** The number of compiled templates each thread keeps. */
+        constexpr std::size_t markup_cache_size = 32;
+
+        /**
+         * Applies one word of a tag to `state`. Returns false if the word is not a style.
+        */
+        inline bool applyMarkupWord(SgrState &state, std::string_view word, bool background)
+        {
+            static constexpr std::pair<std::string_view, Codes> attributes[] = {
+                {"bold", Codes::BRIGHT}, {"b", Codes::BRIGHT}, {"dim", Codes::DIM}, {"italic", Codes::ITALIC},
+                {"i", Codes::ITALIC}, {"underline", Codes::UNDERLINE}, {"u", Codes::UNDERLINE},
+                {"flash", Codes::FLASH}, {"blink", Codes::FLASH}, {"reverse", Codes::REVERSE},
+                {"hidden", Codes::HIDDEN}, {"strike", Codes::STRIKE}, {"s", Codes::STRIKE}};
+            static constexpr std::pair<std::string_view, int> colors[] = {
+                {"black", 0}, {"red", 1}, {"green", 2}, {"yellow", 3}, {"blue", 4}, {"purple", 5},
+                {"magenta", 5}, {"cyan", 6}, {"white", 7}, {"default", 9}};
+            const ColorMode mode = background ? ColorMode::BACKGROUND : ColorMode::FOREGROUND;
+            if (!background)
+            {
+                for (const auto &attribute : attributes)
+                {
+                    if (word == attribute.first)
+                    {
+                        state.apply(attribute.second);
+                        return true;
+                    }
+                }
+            }
+            for (const auto &color : colors)
+            {
+                if (word == color.first)
+                {
+                    state.apply(static_cast<Codes>((background ? 40 : 30) + color.second));
+                    return true;
+                }
+            }
+            if (word.size() > 7 && word.substr(0, 6) == "color(" && word.back() == ')')
+            {
+                int id = 0;
+                const char *last = word.data() + word.size() - 1;
+                const std::from_chars_result res = std::from_chars(word.data() + 6, last, id);
+                if (res.ec != std::errc() || res.ptr != last || !validateColorID(id)) return false;
+                state.apply(Col256(mode, id));
+                return true;
+            }
+            if (word.size() == 7 && word[0] == '#')
+            {
+                unsigned value = 0;
+                const std::from_chars_result res = std::from_chars(word.data() + 1, word.data() + 7, value, 16);
+                if (res.ec != std::errc() || res.ptr != word.data() + 7) return false;
+                state.apply(ColRGB(mode, static_cast<int>(value >> 16), static_cast<int>(value >> 8 & 0xFF),
+                                   static_cast<int>(value & 0xFF)));
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Applies the words of a tag to `state`. Returns false, leaving `state` unspecified, if the tag has a word that is not a style.
+        */
+        inline bool applyMarkupTag(SgrState &state, std::string_view tag)
+        {
+            bool any = false;
+            bool background = false;
+            std::size_t i = 0;
+            while (i < tag.size())
+            {
+                if (tag[i] == ' ')
+                {
+                    i++;
+                    continue;
+                }
+                const std::size_t end = std::min(tag.find(' ', i), tag.size());
+                const std::string_view word = tag.substr(i, end - i);
+                i = end;
+                if (word == "on" && !background)
+                {
+                    background = true;
+                    continue;
+                }
+                if (!applyMarkupWord(state, word, background)) return false;
+                background = false;
+                any = true;
+            }
+            return any && !background;
+        }
+
+        inline void compileMarkup(CompiledMarkup &compiled, std::string_view markup, ColorSupport support)
+        {
+            compiled.source.assign(markup.data(), markup.size());
+            compiled.support = static_cast<int>(support);
+            compiled.bytes.clear();
+            compiled.fields.clear();
+            compiled.field_states.clear();
+
+            StringSink sink{compiled.bytes};
+            std::vector<SgrState> stack;
+            SgrState wanted, shown;
+            // Transitions are rendered before the next text, so that adjacent tags share one sequence.
+            auto restyle = [&] {
+                if (support == ColorSupport::NONE) return;
+                SgrState target = wanted;
+                downgradeColor(target.foreground, support);
+                downgradeColor(target.background, support);
+                renderTransition(sink, shown, target);
+                shown = target;
+            };
+            auto text = [&](const char *data, std::size_t size) {
+                restyle();
+                compiled.bytes.append(data, size);
+            };
+
+            std::size_t i = 0;
+            while (i < markup.size())
+            {
+                const std::size_t special = markup.find_first_of("[]{}", i);
+                if (special == std::string_view::npos)
+                {
+                    text(markup.data() + i, markup.size() - i);
+                    break;
+                }
+                if (special != i) text(markup.data() + i, special - i);
+                i = special;
+                const char c = markup[i];
+                const char following = i + 1 < markup.size() ? markup[i + 1] : '\0';
+                if (c == '{' && following == '}')
+                {
+                    restyle();
+                    compiled.fields.push_back(compiled.bytes.size());
+                    compiled.field_states.push_back(shown);
+                    i += 2;
+                }
+                else if (following == c)
+                {
+                    text(&c, 1);
+                    i += 2;
+                }
+                else if (c == '[')
+                {
+                    const std::size_t close = markup.find(']', i);
+                    const std::string_view tag = close == std::string_view::npos ? std::string_view()
+                                                                                 : markup.substr(i + 1, close - i - 1);
+                    SgrState next = wanted;
+                    if (tag == "/")
+                    {
+                        wanted = stack.empty() ? SgrState() : stack.back();
+                        if (!stack.empty()) stack.pop_back();
+                        i = close + 1;
+                    }
+                    else if (close != std::string_view::npos && applyMarkupTag(next, tag))
+                    {
+                        stack.push_back(wanted);
+                        wanted = next;
+                        i = close + 1;
+                    }
+                    else
+                    {
+                        text(&c, 1);
+                        i++;
+                    }
+                }
+                else
+                {
+                    text(&c, 1);
+                    i++;
+                }
+            }
+            if (support != ColorSupport::NONE)
+            {
+                renderTransition(sink, shown, SgrState());
+            }
+        }
+
+        /**
+         * Returns the compiled form of `markup` for the given color support, compiling it on first use.
+         * Templates are looked up by the hash of their contents in a small per-thread cache, which compiles
+         * a template into the least recently used slot when it is full.
+        */
+        inline const CompiledMarkup &compiledMarkup(std::string_view markup, ColorSupport support = getColorSupport())
+        {
+            thread_local std::array<CompiledMarkup, markup_cache_size> cache;
+            thread_local std::uint64_t clock = 0;
+
+            const std::size_t hash = std::hash<std::string_view>()(markup);
+            CompiledMarkup *oldest = &cache[0];
+            for (CompiledMarkup &entry : cache)
+            {
+                if (entry.hash == hash && entry.support == static_cast<int>(support) && entry.source == markup)
+                {
+                    entry.used = ++clock;
+                    return entry;
+                }
+                if (entry.used < oldest->used)
+                {
+                    oldest = &entry;
+                }
+            }
+            compileMarkup(*oldest, markup, support);
+            oldest->hash = hash;
+            oldest->used = ++clock;
+            return *oldest;
+        }
+
+        template<typename... Args>
+        void markupTo(std::string &out, std::string_view markup, ColorSupport support, const Args &...args)
+        {
+            using Appender = void (*)(std::string &, const void *);
+            const Appender appenders[] = {&appendErased<Args>..., nullptr};
+            const void *values[] = {static_cast<const void *>(&args)..., nullptr};
+            const CompiledMarkup &compiled = compiledMarkup(markup, support);
+            out.reserve(out.size() + compiled.bytes.size() + 16 * sizeof...(Args));
+            std::size_t from = 0;
+            const std::size_t count = std::min(compiled.fields.size(), sizeof...(Args));
+            const FormatScope scope(support, SgrState());
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out.append(compiled.bytes, from, compiled.fields[i] - from);
+                formatContext().around = compiled.field_states[i];
+                appenders[i](out, values[i]);
+                from = compiled.fields[i];
+            }
+            out.append(compiled.bytes, from, std::string::npos);
+        }
+    } // namespace detail
+
+    /**
+     * @brief A markup template checked at compile time against the number of its arguments.
+     *
+     * As with `FormatString`, the check needs C++20; with C++17 a mismatched template throws
+     * `std::invalid_argument` when it is used.
+     */
+    template<typename... Args>
+    using MarkupString = detail::CheckedFormat<typename detail::Identity<Args>::type...>;
+
+    /**
+     * Appends the rendered markup template to `out`, e.g. `append_markup(line, "[b red]ERROR[/] took {}ms", ms)`.
+     *
+     * @param out    The string to append to. It only allocates if its capacity is exceeded.
+     * @param markup The markup template.
+     * @param args   The arguments of its `{}` fields.
+     */
+    template<typename... Args>
+    void append_markup(std::string &out, MarkupString<Args...> markup, Args &&...args)
+    {
+        detail::markupTo(out, markup.get(), getColorSupport(), args...);
+    }
+
+    /**
+     * Renders a markup template, e.g. `render("[b red]ERROR[/] took [cyan]{}ms[/]", ms)`.
+     *
+     * @param markup The markup template.
+     * @param args   The arguments of its `{}` fields.
+     * @return The text with its escape sequences, ending in the default state.
+     */
+    template<typename... Args>
+    std::string render(MarkupString<Args...> markup, Args &&...args)
+    {
+        std::string res;
+        detail::markupTo(res, markup.get(), getColorSupport(), args...);
+        return res;
+    }
+
+    /** @} */ // end of Markup_group
+
+    /**
+     * @ingroup Construct_group
+     * @brief Struct for storing a preset with its escape sequences already rendered.
+     *
+     * A registered preset does not change between calls, so its prefix and suffix are rendered once
+     * by `compilePreset()` and printing only has to copy the stored bytes.
+     */
+    struct CompiledPreset
+    {
+        /**
+         * The rendered prefix, identical to `parse(config, ParseMode::PREFIX)`.
+        */
+        std::string prefix;
+        /**
+         * The rendered suffix, identical to `parse(config, ParseMode::SUFFIX)`.
+        */
+        std::string suffix;
+
+        /**
+         * The texts of the prefix and the suffix, without escape sequences.
+        */
+        std::string prefix_text, suffix_text;
+
+        /**
+         * The styles applied at each boundary of a printed line, in rendering order: before the prefix text,
+         * before the printed text, before the suffix text and after it.
+         * `StyledWriter` applies them to its `SgrState` when tracking the terminal state.
+        */
+        StyleList<Color> prefix_styles, text_styles, suffix_styles, end_styles;
+
+        /**
+         * The state the printed text is shown in, after `prefix_styles` and `text_styles`. Styled arguments
+         * formatted into the text switch back to it when they end.
+        */
+        SgrState text_state;
+
+        /**
+         * Whether a new line follows the suffix.
+        */
+        bool trailing_newline = true;
+    };
+
+    /**
+     * @ingroup Construct_group
+     * @brief A lightweight reference to a registered preset.
+     *
+     * A handle is a dense index into the preset registry, returned by `addPreset()` or `getPresetHandle()`.
+     * Printing through a handle skips the name lookup entirely.
+     */
+    struct PresetHandle
+    {
+        /**
+         * The index of the preset in the registry.
+        */
+        std::size_t index;
+    };
+
+    namespace detail
+    {
+        /**
+         * A preset compiled for every color support, indexed by `ColorSupport`, so that each target
+         * prints it with its own color support.
+        */
+        using PresetVariants = std::array<std::shared_ptr<const CompiledPreset>, 4>;
+
+        /**
+         * An immutable view of every registered preset. Writers never modify a published snapshot.
+         * Snapshots share the compiled presets that did not change between them.
+        */
+        struct PresetSnapshot
+        {
+            std::vector<PresetVariants> table;
+            std::map<std::string, PresetHandle, std::less<>> handles;
+        };
+
+        /**
+         * A reader thread's announcement of the snapshot it reads through. Slots are never freed while the
+         * program runs; a thread that exits releases its slot for the next thread that starts reading.
+        */
+        struct ReaderSlot
+        {
+            std::atomic<const PresetSnapshot *> snapshot{nullptr};
+            std::atomic<bool> in_use{true};
+            ReaderSlot *next = nullptr;
+        };
+
+        /**
+         * The registry behind `addPreset()`, `print()` and `style()`.
+         *
+         * Each thread reads through its own pointer to a snapshot, and only refreshes it when `version` has
+         * changed, so readers neither lock nor touch a reference count while the presets stay the same. Refreshing
+         * takes no lock either: the thread announces the snapshot it is about to read through in its `ReaderSlot`
+         * (a hazard pointer) and checks that it is still the current one.
+         * Writers serialize on `write_mutex`, copy the current snapshot, modify the copy and publish it. After
+         * publishing, they free every retired snapshot that no slot announces, so at most one snapshot per reading
+         * thread is kept alive, even for threads that stopped reading.
+        */
+        struct PresetRegistry
+        {
+            std::mutex write_mutex;
+            std::atomic<const PresetSnapshot *> current{new PresetSnapshot()};
+            /** Incremented on every publish. Threads start at 0 and refresh on their first read. */
+            std::atomic<std::size_t> version{1};
+            std::atomic<ReaderSlot *> readers{nullptr};
+            /** Snapshots replaced by a publish that some thread may still read through. Guarded by `write_mutex`. */
+            std::vector<const PresetSnapshot *> retired;
+
+            PresetRegistry() = default;
+            PresetRegistry(const PresetRegistry &) = delete;
+            PresetRegistry &operator=(const PresetRegistry &) = delete;
+
+            ~PresetRegistry()
+            {
+                delete current.load(std::memory_order_relaxed);
+                for (const PresetSnapshot *snapshot : retired)
+                {
+                    delete snapshot;
+                }
+                for (ReaderSlot *slot = readers.load(std::memory_order_relaxed); slot != nullptr;)
+                {
+                    ReaderSlot *next = slot->next;
+                    delete slot;
+                    slot = next;
+                }
+            }
+
+            /**
+             * Claims the slot of a thread that has exited, or adds a new one.
+            */
+            ReaderSlot *claimSlot()
+            {
+                for (ReaderSlot *slot = readers.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+                {
+                    bool in_use = false;
+                    if (slot->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        return slot;
+                    }
+                }
+                ReaderSlot *slot = new ReaderSlot();
+                slot->next = readers.load(std::memory_order_relaxed);
+                while (!readers.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+                return slot;
+            }
+
+            const PresetSnapshot &snapshot()
+            {
+                struct Reader
+                {
+                    ReaderSlot *slot = nullptr;
+                    const PresetSnapshot *snapshot = nullptr;
+                    std::size_t version = 0;
+
+                    ~Reader()
+                    {
+                        if (slot == nullptr) return;
+                        slot->snapshot.store(nullptr, std::memory_order_release);
+                        slot->in_use.store(false, std::memory_order_release);
+                    }
+                };
+                thread_local Reader reader;
+                const std::size_t latest_version = version.load(std::memory_order_acquire);
+                if (reader.version != latest_version)
+                {
+                    if (reader.slot == nullptr)
+                    {
+                        reader.slot = claimSlot();
+                    }
+                    // Announce the snapshot before using it, and retry if a writer replaced it in the meantime,
+                    // since the writer might not have seen the announcement.
+                    const PresetSnapshot *latest = current.load(std::memory_order_seq_cst);
+                    for (;;)
+                    {
+                        reader.slot->snapshot.store(latest, std::memory_order_seq_cst);
+                        const PresetSnapshot *check = current.load(std::memory_order_seq_cst);
+                        if (check == latest) break;
+                        latest = check;
+                    }
+                    reader.snapshot = latest;
+                    reader.version = latest_version;
+                }
+                return *reader.snapshot;
+            }
+
+            // The functions below must be called with write_mutex held.
+
+            /**
+             * The current snapshot, to be copied by a writer.
+            */
+            const PresetSnapshot &latest() const noexcept
+            {
+                return *current.load(std::memory_order_relaxed);
+            }
+
+            void publish(PresetSnapshot next)
+            {
+                const PresetSnapshot *published = new PresetSnapshot(std::move(next));
+                retired.push_back(current.exchange(published, std::memory_order_seq_cst));
+                version.fetch_add(1, std::memory_order_release);
+
+                std::vector<const PresetSnapshot *> announced;
+                for (ReaderSlot *slot = readers.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+                {
+                    announced.push_back(slot->snapshot.load(std::memory_order_seq_cst));
+                }
+                auto unused = std::remove_if(retired.begin(), retired.end(), [&announced](const PresetSnapshot *snapshot) {
+                    if (std::find(announced.begin(), announced.end(), snapshot) != announced.end()) return false;
+                    delete snapshot;
+                    return true;
+                });
+                retired.erase(unused, retired.end());
+            }
+        };
+
+        inline PresetRegistry registry;
+    } // namespace detail
+
+    namespace detail
+    {
+        /**
+         * Appends the styles of one boundary in the order `renderStyleString()` renders them.
+        */
+        inline void collectStyles(StyleList<Color> &out, const StyleList<Codes> &col16,
+                                  const StyleList<Col256> &col256, const StyleList<Color> &colors)
+        {
+            out.reserve(col16.size() + col256.size() + colors.size());
+            for (Codes col : col16)
+            {
+                out.emplace_back(col);
+            }
+            for (const Col256 &col : col256)
+            {
+                out.emplace_back(col);
+            }
+            for (Color col : colors)
+            {
+                out.push_back(col);
+            }
+        }
+
+        inline CompiledPreset compile(const PresetConfig &preset)
+        {
+            CompiledPreset res;
+            res.prefix = parse(preset, ParseMode::PREFIX);
+            res.suffix = parse(preset, ParseMode::SUFFIX);
+            res.prefix_text = preset.prefix.text;
+            res.suffix_text = preset.suffix.text;
+            collectStyles(res.prefix_styles, preset.prefix.prestyle16, preset.prefix.prestlye256, preset.prefix.prestyles);
+            collectStyles(res.text_styles, preset.prefix.poststyle16, preset.prefix.poststyle256, preset.prefix.poststyles);
+            collectStyles(res.suffix_styles, preset.suffix.prestyle16, preset.suffix.prestlye256, preset.suffix.prestyles);
+            collectStyles(res.end_styles, preset.suffix.poststyle16, preset.suffix.poststyle256, preset.suffix.poststyles);
+            res.text_state.apply(res.prefix_styles);
+            res.text_state.apply(res.text_styles);
+            res.trailing_newline = preset.config.trailing_newline;
+            return res;
+        }
+    } // namespace detail
+
+    /**
+     * @ingroup Construct_group
+     * Renders the prefix and suffix of the given `preset` configuration.
+     *
+     * Colors are downgraded to `support` first (see `downgradePreset()`), so no capability checks are left for print time.
+     *
+     * @param preset The preset configuration to compile.
+     * @param support The color support to compile for (default: `getColorSupport()`).
+     * @return The compiled preset.
+     */
+    inline CompiledPreset compilePreset(const PresetConfig &preset, ColorSupport support = getColorSupport()) noexcept
+    {
+        if (support == ColorSupport::COLRGB)
+        {
+            return detail::compile(preset);
+        }
+        return detail::compile(downgradePreset(preset, support));
+    }
+
+    namespace detail
+    {
+        inline PresetVariants compileVariants(const PresetConfig &preset)
+        {
+            PresetVariants variants;
+            for (int support = 0; support < 4; support++)
+            {
+                variants[support] = std::make_shared<const CompiledPreset>(compilePreset(preset, static_cast<ColorSupport>(support)));
+            }
+            return variants;
+        }
+    } // namespace detail
+
+    /**
+     * @ingroup Construct_group
+     * @brief Adds a preset with the given name and configuration.
+     *
+     * This function adds a preset with the specified name and configuration to the termstyle library.
+     * It may be called while other threads are printing.
+     *
+     * @param name The name of the preset.
+     * @param preset The configuration for the preset.
+     * @return The handle of the new preset.
+     */
+    inline PresetHandle addPreset(std::string name, PresetConfig preset)
+    {
+        std::lock_guard<std::mutex> lock(detail::registry.write_mutex);
+        if (presets.find(name) != presets.end()) // preset already exists
+        {
+            throw PresetNameUsed(name);
+        }
+
+        if (preset.config.leading_restore)
+        {
+            preset.prefix.prestyles.insert(preset.prefix.prestyles.begin(), Color(Codes::RESTORE));
+        }
+        if (preset.config.trailing_restore)
+        {
+            preset.suffix.poststyles.emplace_back(Color(Codes::RESTORE));
+        }
+
+        detail::PresetSnapshot next = detail::registry.latest();
+        PresetHandle handle{next.table.size()};
+        next.table.push_back(detail::compileVariants(preset));
+        next.handles.emplace(name, handle);
+        presets[std::move(name)] = std::move(preset);
+        detail::registry.publish(std::move(next));
+        return handle;
+    }
+
+    /**
+     * @ingroup Construct_group
+     * @brief Looks up the handle of a registered preset.
+     *
+     * @param name The name of the preset.
+     * @return The handle of the preset.
+     */
+    inline PresetHandle getPresetHandle(std::string_view name)
+    {
+        const detail::PresetSnapshot &snapshot = detail::registry.snapshot();
+        auto it = snapshot.handles.find(name);
+        if (it == snapshot.handles.end())
+        {
+            throw PresetNotFound(std::string(name));
+        }
+        return it->second;
+    }
+
+    namespace detail
+    {
+        /**
+         * The compiled preset referred to by `handle`, for holders that outlive the current call,
+         * such as queued lines and `StyledCout`.
+        */
+        inline const std::shared_ptr<const CompiledPreset> &sharedPreset(PresetHandle handle, ColorSupport support)
+        {
+            const PresetSnapshot &snapshot = registry.snapshot();
+            if (handle.index >= snapshot.table.size())
+            {
+                throw PresetNotFound("#" + std::to_string(handle.index));
+            }
+            return snapshot.table[handle.index][static_cast<int>(support)];
+        }
+    } // namespace detail
+
+    /**
+     * @ingroup Construct_group
+     * @brief Returns the compiled preset referred to by `handle`.
+     *
+     * The returned reference stays valid until the preset is recompiled and the calling thread has looked up
+     * a preset again, so it is meant to be used right away. Copy the preset to keep it longer.
+     *
+     * @param handle The handle of the preset.
+     * @param support The color support the preset is compiled for (default: `getColorSupport()`).
+     * @return The compiled preset.
+     */
+    inline const CompiledPreset &getCompiledPreset(PresetHandle handle, ColorSupport support = getColorSupport())
+    {
+        return *detail::sharedPreset(handle, support);
+    }
+
+    /**
+     * @ingroup Construct_group
+     * @brief Re-renders a registered preset from its configuration in `presets`.
+     *
+     * Call this after modifying `presets[name]` in place.
+     *
+     * @param name The name of the preset.
+     */
+    inline void recompilePreset(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(detail::registry.write_mutex);
+        auto it = presets.find(name);
+        if (it == presets.end())
+        {
+            throw PresetNotFound(name);
+        }
+        detail::PresetSnapshot next = detail::registry.latest();
+        next.table[next.handles.find(name)->second.index] = detail::compileVariants(it->second);
+        detail::registry.publish(std::move(next));
+    }
+
+    /**
+     * @ingroup Construct_group
+     * @brief Re-renders every registered preset from its configuration in `presets`.
+     */
+    inline void recompilePresets()
+    {
+        std::lock_guard<std::mutex> lock(detail::registry.write_mutex);
+        detail::PresetSnapshot next = detail::registry.latest();
+        for (const auto &entry : presets)
+        {
+            next.table[next.handles.find(entry.first)->second.index] = detail::compileVariants(entry.second);
+        }
+        detail::registry.publish(std::move(next));
+    }
+
+    /**
+     * @ingroup Capability_group
+     * @brief Overrides the detected color support of standard output and of every target that has not been
+     * given its own with `OutputTarget::setColorSupport()`.
+     *
+     * Presets are compiled for every color support when registered, so this takes effect immediately.
+     *
+     * @param support The color support to use.
+     */
+    inline void setColorSupport(ColorSupport support)
+    {
+        detail::color_support.store(static_cast<int>(support), std::memory_order_relaxed);
+        detail::color_support_set.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @defgroup Output_group Output Targets
+     * Content related to where styled output is written.
+     * @{
+    */
+
+    namespace detail
+    {
+        /**
+         * Writes all of `data` to the file descriptor `fd`, retrying on partial writes and interrupts.
+         * @return False if the write failed.
+        */
+        inline bool writeFd(int fd, const char *data, std::size_t size) noexcept
+        {
+            while (size > 0)
+            {
+#if defined(_WIN32)
+                int chunk = size > 0x40000000 ? 0x40000000 : static_cast<int>(size);
+                int written = _write(fd, data, static_cast<unsigned int>(chunk));
+#else
+                ssize_t written = ::write(fd, data, size);
+#endif
+                if (written < 0)
+                {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                data += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+        }
+
+        /**
+         * The line length above which `FdTarget` gathers the parts of a line instead of copying them.
+         * Below it, copying costs less than the extra work `writev` does per buffer.
+        */
+        inline constexpr std::size_t gather_threshold = 2048;
+
+#if !defined(_WIN32)
+#if defined(IOV_MAX)
+        inline constexpr std::size_t iov_max = IOV_MAX;
+#else
+        inline constexpr std::size_t iov_max = 1024;
+#endif
+
+        /**
+         * Writes all of `iov` to the file descriptor `fd` with as few `writev` calls as possible,
+         * at most `iov_max` buffers at a time, retrying on partial writes and interrupts. Modifies `iov`.
+         * @return False if the write failed.
+        */
+        inline bool writevFd(int fd, struct iovec *iov, std::size_t count) noexcept
+        {
+            while (count > 0)
+            {
+                ssize_t written = ::writev(fd, iov, static_cast<int>(std::min(count, iov_max)));
+                if (written < 0)
+                {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                std::size_t left = static_cast<std::size_t>(written);
+                while (count > 0 && left >= iov->iov_len)
+                {
+                    left -= iov->iov_len;
+                    iov++;
+                    count--;
+                }
+                if (left > 0)
+                {
+                    iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+                    iov->iov_len -= left;
+                }
+            }
+            return true;
+        }
+#endif
+
+        /**
+         * A per-thread scratch buffer for assembling a line before a single write.
+        */
+        inline std::string &lineBuffer()
+        {
+            thread_local std::string buffer;
+            buffer.clear();
+            return buffer;
+        }
+    } // namespace detail
+
+    /**
+     * @brief Base class for everything styled output can be written to.
+     *
+     * `print()`, `style()`, `StyledWriter` and `OnExit` all write through an `OutputTarget`.
+     * Implementations must accept concurrent calls from several threads.
+     *
+     * Each target has its own color support, so output to a log file carries no escape sequences
+     * while output to the terminal does. See `colorSupport()`.
+     */
+    class OutputTarget
+    {
+    private:
+        /** The color support set with `setColorSupport()`, or -1. */
+        std::atomic<int> forced_support{-1};
+        /** The color support detected on first use, or -1. */
+        std::atomic<int> detected_support{-1};
+
+    protected:
+        /**
+         * Detects the color support of what the target writes to. Called on first use.
+         * The default implementation returns the color support of standard output, `getColorSupport()`.
+        */
+        virtual ColorSupport detectSupport() noexcept
+        {
+            return getColorSupport();
+        }
+
+    public:
+        virtual ~OutputTarget() = default;
+
+        /**
+         * @brief Returns the color support output written to this target is rendered for.
+         *
+         * The first of: the value set with `setColorSupport()` on this target, the value set with the global
+         * `termstyle::setColorSupport()`, and the value detected for this target on first use, e.g. from
+         * the file descriptor of an `FdTarget` or `FileTarget`.
+        */
+        ColorSupport colorSupport() noexcept
+        {
+            int support = forced_support.load(std::memory_order_relaxed);
+            if (support >= 0)
+            {
+                return static_cast<ColorSupport>(support);
+            }
+            if (detail::color_support_set.load(std::memory_order_relaxed))
+            {
+                return getColorSupport();
+            }
+            support = detected_support.load(std::memory_order_relaxed);
+            if (support < 0)
+            {
+                support = static_cast<int>(detectSupport());
+                detected_support.store(support, std::memory_order_relaxed);
+            }
+            return static_cast<ColorSupport>(support);
+        }
+
+        /**
+         * @brief Overrides the color support of this target, also over the global `termstyle::setColorSupport()`.
+         *
+         * @param support The color support to render output to this target for.
+        */
+        void setColorSupport(ColorSupport support) noexcept
+        {
+            forced_support.store(static_cast<int>(support), std::memory_order_relaxed);
+        }
+
+        /**
+         * Writes raw bytes to the target.
+         *
+         * @param data The bytes to write.
+        */
+        virtual void write(std::string_view data) = 0;
+
+        /**
+         * Writes a whole styled line. The default implementation writes the three parts in turn;
+         * targets override it to emit the line at once.
+         *
+         * @param prefix The rendered prefix.
+         * @param text The text.
+         * @param suffix The rendered suffix.
+        */
+        virtual void writeLine(std::string_view prefix, std::string_view text, std::string_view suffix)
+        {
+            write(prefix);
+            write(text);
+            write(suffix);
+        }
+
+        /**
+         * Writes several buffers in order, like `writev(2)`. The default implementation copies them into
+         * one buffer and passes it to `write()`; targets override it to write the buffers without copying.
+         *
+         * @param parts The buffers to write.
+         * @param count The number of buffers.
+        */
+        virtual void writev(const std::string_view *parts, std::size_t count)
+        {
+            std::string &buffer = detail::lineBuffer();
+            for (std::size_t i = 0; i < count; i++)
+            {
+                buffer.append(parts[i].data(), parts[i].size());
+            }
+            write(buffer);
+        }
+
+        /**
+         * Flushes any output buffered by the target.
+        */
+        virtual void flush() {}
+
+        /**
+         * @return The `std::ostream` behind the target, or `nullptr` if it is not backed by a stream.
+         * `StyledCout` streams into it directly; for other targets it buffers the line itself.
+        */
+        virtual std::ostream *stream() noexcept
+        {
+            return nullptr;
+        }
+    };
+
+    /**
+     * @brief An `OutputTarget` that writes to a `std::ostream`, such as `std::cout` or a `std::ostringstream`.
+     *
+     * `std::cout` has the color support of standard output, and `std::cerr` and `std::clog` that of standard error.
+     * Other streams, like files and string streams, have none unless `FORCE_COLOR` is set.
+     */
+    class StreamTarget : public OutputTarget
+    {
+    private:
+        std::ostream &os;
+
+    protected:
+        ColorSupport detectSupport() noexcept override
+        {
+            return detail::streamColorSupport(os);
+        }
+
+    public:
+        explicit StreamTarget(std::ostream &os) : os(os) {}
+
+        void write(std::string_view data) override
+        {
+            os.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        void writev(const std::string_view *parts, std::size_t count) override
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                write(parts[i]);
+            }
+        }
+
+        void flush() override
+        {
+            os.flush();
+        }
+
+        std::ostream *stream() noexcept override
+        {
+            return &os;
+        }
+    };
+
+    /**
+     * @brief An `OutputTarget` that writes to a C `FILE` stream. Each line is passed to a single `fwrite`.
+     */
+    class FileTarget : public OutputTarget
+    {
+    private:
+        std::FILE *file;
+
+    protected:
+        /**
+         * Detects the color support from the file descriptor of the stream, so files get none.
+        */
+        ColorSupport detectSupport() noexcept override
+        {
+#if defined(_WIN32)
+            return termstyle::detectColorSupport(_fileno(file));
+#else
+            return termstyle::detectColorSupport(fileno(file));
+#endif
+        }
+
+    public:
+        explicit FileTarget(std::FILE *file) : file(file) {}
+
+        void write(std::string_view data) override
+        {
+            std::fwrite(data.data(), 1, data.size(), file);
+        }
+
+        void writeLine(std::string_view prefix, std::string_view text, std::string_view suffix) override
+        {
+            std::string &line = detail::lineBuffer();
+            line.append(prefix).append(text).append(suffix);
+            write(line);
+        }
+
+        void flush() override
+        {
+            std::fflush(file);
+        }
+    };
+
+    /**
+     * @brief An `OutputTarget` that writes straight to a file descriptor, bypassing iostreams and stdio.
+     *
+     * Each line is emitted with a single system call, so lines from different threads never interleave.
+     * On POSIX systems, lines are gathered with `writev(2)` instead of being copied into one buffer.
+     */
+    class FdTarget : public OutputTarget
+    {
+    private:
+        int fd;
+
+    protected:
+        ColorSupport detectSupport() noexcept override
+        {
+            return termstyle::detectColorSupport(fd);
+        }
+
+    public:
+        explicit FdTarget(int fd) : fd(fd) {}
+
+        void write(std::string_view data) override
+        {
+            detail::writeFd(fd, data.data(), data.size());
+        }
+
+        /**
+         * Writes the line with a single system call. Lines longer than `detail::gather_threshold` are written with
+         * one `writev(2)` of the prefix, the text and the suffix, so the text is never copied; shorter lines are
+         * copied into one buffer, which is cheaper than gathering them. Partial writes are resumed where they stopped.
+        */
+        void writeLine(std::string_view prefix, std::string_view text, std::string_view suffix) override
+        {
+#if defined(_WIN32)
+            std::string &line = detail::lineBuffer();
+            line.append(prefix).append(text).append(suffix);
+            write(line);
+#else
+            if (prefix.size() + text.size() + suffix.size() <= detail::gather_threshold)
+            {
+                std::string &line = detail::lineBuffer();
+                line.append(prefix).append(text).append(suffix);
+                write(line);
+                return;
+            }
+            struct iovec iov[3];
+            std::size_t count = 0;
+            for (std::string_view part : {prefix, text, suffix})
+            {
+                if (part.empty()) continue;
+                iov[count].iov_base = const_cast<char *>(part.data());
+                iov[count].iov_len = part.size();
+                count++;
+            }
+            detail::writevFd(fd, iov, count);
+#endif
+        }
+
+        /**
+         * Writes the buffers with `writev(2)`, so they are not copied. More than `IOV_MAX` buffers take
+         * several calls, and lines from other threads may then come in between.
+        */
+        void writev(const std::string_view *parts, std::size_t count) override
+        {
+#if defined(_WIN32)
+            OutputTarget::writev(parts, count);
+#else
+            thread_local std::vector<struct iovec> iov;
+            iov.resize(count);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                iov[i].iov_base = const_cast<char *>(parts[i].data());
+                iov[i].iov_len = parts[i].size();
+            }
+            detail::writevFd(fd, iov.data(), count);
+#endif
+        }
+
+        /**
+         * @return The file descriptor written to.
+        */
+        int getFd() const noexcept
+        {
+            return fd;
+        }
+    };
+
+    /**
+     * @brief An `OutputTarget` that keeps the most recent output in memory, mainly for tests.
+     */
+    class RingBufferTarget : public OutputTarget
+    {
+    private:
+        std::mutex mutex;
+        std::vector<char> ring;
+        std::size_t head = 0;
+        std::size_t used = 0;
+
+    public:
+        /**
+         * @param capacity The number of bytes kept. Older output is overwritten.
+        */
+        explicit RingBufferTarget(std::size_t capacity) : ring(capacity) {}
+
+        void write(std::string_view data) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ring.empty()) return;
+            if (data.size() > ring.size())
+            {
+                data.remove_prefix(data.size() - ring.size());
+            }
+            for (char ch : data)
+            {
+                ring[(head + used) % ring.size()] = ch;
+                if (used < ring.size())
+                {
+                    used++;
+                }
+                else
+                {
+                    head = (head + 1) % ring.size();
+                }
+            }
+        }
+
+        void writeLine(std::string_view prefix, std::string_view text, std::string_view suffix) override
+        {
+            std::string &line = detail::lineBuffer();
+            line.append(prefix).append(text).append(suffix);
+            write(line);
+        }
+
+        /**
+         * @return The buffered output, oldest byte first.
+        */
+        std::string contents()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::string res;
+            res.reserve(used);
+            for (std::size_t i = 0; i < used; i++)
+            {
+                res += ring[(head + i) % ring.size()];
+            }
+            return res;
+        }
+
+        /**
+         * Discards the buffered output.
+        */
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            head = 0;
+            used = 0;
+        }
+    };
+
+    namespace detail
+    {
+        inline StreamTarget cout_target{std::cout};
+        inline std::atomic<OutputTarget *> default_target{&cout_target};
+    } // namespace detail
+
+    /**
+     * @brief Returns the target used when no target is passed explicitly. Initially `std::cout`.
+     */
+    inline OutputTarget &defaultTarget() noexcept
+    {
+        return *detail::default_target.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Changes the target used when no target is passed explicitly.
+     *
+     * @param target The new default target. It must outlive every use of the default target,
+     *               including the restore code written at exit.
+     */
+    inline void setDefaultTarget(OutputTarget &target) noexcept
+    {
+        detail::default_target.store(&target, std::memory_order_release);
+    }
+
+    /** @} */ // end of Output_group
+
+    /**
+     * @defgroup PresetUse_group Using Presets
+     * Content related to using presets.
+     * @{
+    */
+
+    /**
+     * Prints the specified text to `out` using the preset referred to by `preset`.
+     *
+     * @param out    The target to write to.
+     * @param preset The handle of the preset style to apply to the text.
+     * @param text   The text to be printed. If not provided, an empty string will be printed.
+     */
+    inline void print(OutputTarget &out, PresetHandle preset, std::string_view text = "")
+    {
+        const CompiledPreset &compiled = getCompiledPreset(preset, out.colorSupport());
+        out.writeLine(compiled.prefix, text, compiled.suffix);
+    }
+
+    /**
+     * Prints the specified text to `out` using the given preset style.
+     *
+     * @param out    The target to write to.
+     * @param preset The name of the preset style to apply to the text.
+     * @param text   The text to be printed. If not provided, an empty string will be printed.
+     */
+    inline void print(OutputTarget &out, std::string_view preset, std::string_view text = "")
+    {
+        print(out, getPresetHandle(preset), text);
+    }
+
+    /**
+     * Prints the specified text to `out` using a compile-time style, followed by a restore code and a new line.
+     *
+     * @param out   The target to write to.
+     * @param style The compile-time style to apply to the text, e.g. `static_style<Codes::BRIGHT>`.
+     * @param text  The text to be printed. If not provided, an empty string will be printed.
+     */
+    template<std::size_t N>
+    void print(OutputTarget &out, const StaticSequence<N> &style, std::string_view text = "")
+    {
+        if (out.colorSupport() == ColorSupport::NONE)
+        {
+            out.writeLine({}, text, "\n");
+            return;
+        }
+        out.writeLine(style.view(), text, static_suffix.view());
+    }
+
+    /**
+     * Prints the formatted arguments to `out` using the preset referred to by `preset`, with a single write.
+     * The arguments are formatted straight into the line between the prefix and the suffix.
+     *
+     * @param out    The target to write to.
+     * @param preset The handle of the preset style to apply to the text.
+     * @param fmt    The format string, e.g. `"x={} y={}"`.
+     * @param args   The arguments to format.
+     */
+    template<typename Arg, typename... Args>
+    void print(OutputTarget &out, PresetHandle preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+    {
+        const CompiledPreset &compiled = getCompiledPreset(preset, out.colorSupport());
+        std::string &line = detail::lineBuffer();
+        const detail::FormatScope scope(out.colorSupport(), compiled.text_state);
+        line.append(compiled.prefix);
+        detail::formatTo<Arg, Args...>(line, fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+        line.append(compiled.suffix);
+        out.write(line);
+    }
+
+    /**
+     * Prints the formatted arguments to `out` using the given preset style, with a single write.
+     *
+     * @param out    The target to write to.
+     * @param preset The name of the preset style to apply to the text.
+     * @param fmt    The format string, e.g. `"x={} y={}"`.
+     * @param args   The arguments to format.
+     */
+    template<typename Arg, typename... Args>
+    void print(OutputTarget &out, std::string_view preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+    {
+        print<Arg, Args...>(out, getPresetHandle(preset), fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Prints the formatted arguments using the preset referred to by `preset`, with a single write.
+     *
+     * @param preset The handle of the preset style to apply to the text.
+     * @param fmt    The format string, e.g. `"x={} y={}"`.
+     * @param args   The arguments to format.
+     */
+    template<typename Arg, typename... Args>
+    void print(PresetHandle preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+    {
+        print<Arg, Args...>(defaultTarget(), preset, fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Prints the formatted arguments using the given preset style, with a single write.
+     *
+     * @param preset The name of the preset style to apply to the text.
+     * @param fmt    The format string, e.g. `"x={} y={}"`.
+     * @param args   The arguments to format.
+     */
+    template<typename Arg, typename... Args>
+    void print(std::string_view preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+    {
+        print<Arg, Args...>(defaultTarget(), getPresetHandle(preset), fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Prints the specified text to `out` using a style expression, followed by a restore code and a new line.
+     *
+     * @param out   The target to write to.
+     * @param style The style expression to apply to the text, e.g. `fg(Codes::FOREGROUND_RED) | bold`.
+     * @param text  The text to be printed. If not provided, an empty string will be printed.
+     */
+    template<typename... Styles>
+    void print(OutputTarget &out, const StyleExpr<Styles...> &style, std::string_view text = "")
+    {
+        char prefix[3 + detail::max_param_length * sizeof...(Styles)];
+        const std::size_t length = detail::renderExpr(prefix, style, out.colorSupport());
+        if (length == 0)
+        {
+            out.writeLine({}, text, "\n");
+            return;
+        }
+        out.writeLine(std::string_view(prefix, length), text, static_suffix.view());
+    }
+
+    /**
+     * Prints the specified text using the preset referred to by `preset`.
+     *
+     * @param preset The handle of the preset style to apply to the text.
+     * @param text   The text to be printed. If not provided, an empty string will be printed.
+     */
+    inline void print(PresetHandle preset, std::string_view text = "")
+    {
+        print(defaultTarget(), preset, text);
+    }
+
+    /**
+     * Prints the specified text using a compile-time style, followed by a restore code and a new line.
+     *
+     * @param style The compile-time style to apply to the text, e.g. `static_style<Codes::BRIGHT>`.
+     * @param text  The text to be printed. If not provided, an empty string will be printed.
+     */
+    template<std::size_t N>
+    void print(const StaticSequence<N> &style, std::string_view text = "")
+    {
+        print(defaultTarget(), style, text);
+    }
+
+    /**
+     * Prints the specified text using a style expression, followed by a restore code and a new line.
+     *
+     * @param style The style expression to apply to the text, e.g. `fg(Codes::FOREGROUND_RED) | bold`.
+     * @param text  The text to be printed. If not provided, an empty string will be printed.
+     */
+    template<typename... Styles>
+    void print(const StyleExpr<Styles...> &style, std::string_view text = "")
+    {
+        print(defaultTarget(), style, text);
+    }
+
+    /**
+     * Prints the specified text using the given preset style.
+     *
+     * @param preset The name of the preset style to apply to the text.
+     * @param text   The text to be printed. If not provided, an empty string will be printed.
+     */
+    inline void print(std::string_view preset, std::string_view text = "")
+    {
+        print(defaultTarget(), getPresetHandle(preset), text);
+    }
+
+    /**
+     * Prints a styled text to `out` with a single write. Unlike presets, no new line is added.
+     *
+     * @param out  The target to write to.
+     * @param text The styled text to print.
+     */
+    inline void print(OutputTarget &out, const StyledText &text)
+    {
+        std::string &line = detail::lineBuffer();
+        detail::StringSink sink{line};
+        detail::renderStyle(sink, text, out.colorSupport());
+        out.write(line);
+    }
+
+    /**
+     * Prints a styled text with a single write. Unlike presets, no new line is added.
+     *
+     * @param text The styled text to print.
+     */
+    inline void print(const StyledText &text)
+    {
+        print(defaultTarget(), text);
+    }
+
+    /**
+     * Prints `text` colored along `gradient` with a single write. Unlike presets, no new line is added.
+     *
+     * @param out      The target to write to.
+     * @param gradient The gradient to color the characters with.
+     * @param text     The text to color.
+     */
+    inline void print(OutputTarget &out, const Gradient &gradient, std::string_view text)
+    {
+        std::string &line = detail::lineBuffer();
+        detail::StringSink sink{line};
+        gradient.render(sink, text, out.colorSupport());
+        out.write(line);
+    }
+
+    /**
+     * Prints `text` colored along `gradient` with a single write. Unlike presets, no new line is added.
+     *
+     * @param gradient The gradient to color the characters with.
+     * @param text     The text to color.
+     */
+    inline void print(const Gradient &gradient, std::string_view text)
+    {
+        print(defaultTarget(), gradient, text);
+    }
+
+    /**
+     * Prints a rendered markup template with a single write. Unlike presets, no new line is added.
+     *
+     * @param out    The target to write to.
+     * @param markup The markup template, e.g. `"[b red]ERROR[/] took [cyan]{}ms[/]\n"`.
+     * @param args   The arguments of its `{}` fields.
+     */
+    template<typename... Args>
+    void print_markup(OutputTarget &out, MarkupString<Args...> markup, Args &&...args)
+    {
+        std::string &line = detail::lineBuffer();
+        detail::markupTo(line, markup.get(), out.colorSupport(), args...);
+        out.write(line);
+    }
+
+    /**
+     * Prints a rendered markup template with a single write. Unlike presets, no new line is added.
+     *
+     * @param markup The markup template, e.g. `"[b red]ERROR[/] took [cyan]{}ms[/]\n"`.
+     * @param args   The arguments of its `{}` fields.
+     */
+    template<typename... Args>
+    void print_markup(MarkupString<Args...> markup, Args &&...args)
+    {
+        print_markup<Args...>(defaultTarget(), markup, std::forward<Args>(args)...);
+    }
+
+    namespace detail
+    {
+        /**
+         * The most buffers `print_lines()` gathers before passing them to the target, `IOV_MAX` on Linux.
+        */
+        inline constexpr std::size_t max_gathered_parts = 1024;
+
+        /**
+         * Whether the text an iterator yields outlives the dereference, so it can be gathered without copying.
+        */
+        template<typename Ref>
+        constexpr bool is_stable_text_v = std::is_lvalue_reference_v<Ref>
+                                          || std::is_same_v<std::decay_t<Ref>, std::string_view>
+                                          || std::is_pointer_v<std::decay_t<Ref>>;
+
+        /**
+         * Writes every line of `[first, last)` in gathered writes. The suffix of a line and the prefix of the
+         * next one are joined once up front, so each line adds two buffers: its text and the joint.
+        */
+        template<typename It>
+        void printLines(OutputTarget &out, const CompiledPreset &compiled, It first, It last)
+        {
+            if (first == last) return;
+            if constexpr (is_stable_text_v<decltype(*first)>)
+            {
+                thread_local std::string joint;
+                thread_local std::vector<std::string_view> parts;
+                joint.assign(compiled.suffix).append(compiled.prefix);
+                parts.clear();
+                auto add = [&](std::string_view part) {
+                    if (part.empty()) return;
+                    parts.push_back(part);
+                    if (parts.size() == max_gathered_parts)
+                    {
+                        out.writev(parts.data(), parts.size());
+                        parts.clear();
+                    }
+                };
+                add(compiled.prefix);
+                add(std::string_view(*first));
+                for (++first; first != last; ++first)
+                {
+                    add(joint);
+                    add(std::string_view(*first));
+                }
+                add(compiled.suffix);
+                if (!parts.empty())
+                {
+                    out.writev(parts.data(), parts.size());
+                }
+            }
+            else
+            {
+                // The texts are temporaries, so they are copied while they are alive.
+                std::string &buffer = lineBuffer();
+                for (; first != last; ++first)
+                {
+                    buffer.append(compiled.prefix).append(std::string_view(*first)).append(compiled.suffix);
+                }
+                out.write(buffer);
+            }
+        }
+    } // namespace detail
+
+    /**
+     * Prints every line of `[first, last)` to `out` using the preset referred to by `preset`.
+     *
+     * The preset is resolved once, and the lines are gathered with the cached prefix and suffix into as few
+     * `OutputTarget::writev()` calls as possible. An `FdTarget` writes up to 512 lines per system call without
+     * copying the texts.
+     *
+     * @param out    The target to write to.
+     * @param preset The handle of the preset style to apply to each line.
+     * @param first  The first line. Lines may be anything convertible to `std::string_view`.
+     * @param last   The end of the lines.
+     */
+    template<typename It>
+    void print_lines(OutputTarget &out, PresetHandle preset, It first, It last)
+    {
+        detail::printLines(out, getCompiledPreset(preset, out.colorSupport()), first, last);
+    }
+
+    /**
+     * Prints every line of `lines` to `out` using the preset referred to by `preset`, like the iterator overload.
+     *
+     * @param out    The target to write to.
+     * @param preset The handle of the preset style to apply to each line.
+     * @param lines  The lines, e.g. a `std::vector<std::string>`.
+     */
+    template<typename Range>
+    void print_lines(OutputTarget &out, PresetHandle preset, const Range &lines)
+    {
+        detail::printLines(out, getCompiledPreset(preset, out.colorSupport()), std::begin(lines), std::end(lines));
+    }
+
+    /**
+     * Prints every line of `[first, last)` to `out` using the given preset style.
+     *
+     * @param out    The target to write to.
+     * @param preset The name of the preset style to apply to each line.
+     * @param first  The first line.
+     * @param last   The end of the lines.
+     */
+    template<typename It>
+    void print_lines(OutputTarget &out, std::string_view preset, It first, It last)
+    {
+        print_lines(out, getPresetHandle(preset), first, last);
+    }
+
+    /**
+     * Prints every line of `lines` to `out` using the given preset style.
+     *
+     * @param out    The target to write to.
+     * @param preset The name of the preset style to apply to each line.
+     * @param lines  The lines.
+     */
+    template<typename Range>
+    void print_lines(OutputTarget &out, std::string_view preset, const Range &lines)
+    {
+        print_lines(out, getPresetHandle(preset), lines);
+    }
+
+    /**
+     * Prints every line of `[first, last)` using the preset referred to by `preset`.
+     *
+     * @param preset The handle of the preset style to apply to each line.
+     * @param first  The first line.
+     * @param last   The end of the lines.
+     */
+    template<typename It>
+    void print_lines(PresetHandle preset, It first, It last)
+    {
+        print_lines(defaultTarget(), preset, first, last);
+    }
+
+    /**
+     * Prints every line of `lines` using the preset referred to by `preset`.
+     *
+     * @param preset The handle of the preset style to apply to each line.
+     * @param lines  The lines.
+     */
+    template<typename Range>
+    void print_lines(PresetHandle preset, const Range &lines)
+    {
+        print_lines(defaultTarget(), preset, lines);
+    }
+
+    /**
+     * Prints every line of `[first, last)` using the given preset style.
+     *
+     * @param preset The name of the preset style to apply to each line.
+     * @param first  The first line.
+     * @param last   The end of the lines.
+     */
+    template<typename It>
+    void print_lines(std::string_view preset, It first, It last)
+    {
+        print_lines(defaultTarget(), getPresetHandle(preset), first, last);
+    }
+
+    /**
+     * Prints every line of `lines` using the given preset style.
+     *
+     * @param preset The name of the preset style to apply to each line.
+     * @param lines  The lines.
+     */
+    template<typename Range>
+    void print_lines(std::string_view preset, const Range &lines)
+    {
+        print_lines(defaultTarget(), getPresetHandle(preset), lines);
+    }
+
+    /**
+     * @brief A class that provides styled output to an output target.
+     * 
+     * The `StyledCout` class allows you to output text with custom styles to an `OutputTarget`, by default `std::cout`.
+     * The prefix is written when it is constructed and the suffix when it is destroyed.
+     * For targets that are not backed by a `std::ostream`, everything is buffered and written as one line on destruction.
+     */
+    class StyledCout
+    {
+    private:
+        /**
+         * The target to write to.
+         * 
+         * @see OutputTarget
+        */
+        OutputTarget *target;
+
+        /**
+         * The rendered prefix and suffix.
+        */
+        std::string_view prefix, suffix;
+
+        /**
+         * Storage for the prefix and suffix, if constructed from a `PresetConfig`.
+        */
+        std::string rendered;
+
+        /**
+         * The registered preset the prefix and suffix point into, kept alive in case it is recompiled meanwhile.
+        */
+        std::shared_ptr<const CompiledPreset> preset;
+
+        /**
+         * The line being built, if the target has no stream.
+        */
+        std::unique_ptr<std::ostringstream> buffer;
+
+    public:
+        explicit StyledCout(std::string_view prefix, std::string_view suffix, OutputTarget &target = defaultTarget())
+            : target(&target), prefix(prefix), suffix(suffix)
+        {
+            if (std::ostream *os = target.stream())
+            {
+                os->write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+            }
+        }
+
+        explicit StyledCout(const CompiledPreset &compiled, OutputTarget &target = defaultTarget())
+            : StyledCout(compiled.prefix, compiled.suffix, target) {}
+
+        explicit StyledCout(std::shared_ptr<const CompiledPreset> compiled, OutputTarget &target = defaultTarget())
+            : StyledCout(*compiled, target)
+        {
+            preset = std::move(compiled);
+        }
+
+        explicit StyledCout(const PresetConfig &config, OutputTarget &target = defaultTarget())
+            : target(&target)
+        {
+            CompiledPreset compiled = compilePreset(config, target.colorSupport());
+            std::size_t prefix_size = compiled.prefix.size();
+            rendered = std::move(compiled.prefix) + compiled.suffix;
+            prefix = std::string_view(rendered).substr(0, prefix_size);
+            suffix = std::string_view(rendered).substr(prefix_size);
+            if (std::ostream *os = target.stream())
+            {
+                os->write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+            }
+        }
+
+        ~StyledCout()
+        {
+            if (std::ostream *os = target->stream())
+            {
+                os->write(suffix.data(), static_cast<std::streamsize>(suffix.size()));
+            }
+            else
+            {
+                target->writeLine(prefix, buffer ? std::string_view(buffer->str()) : std::string_view(), suffix);
+            }
+        }
+
+        template<typename T>
+        std::ostream& operator<<(const T& value)
+        {
+            if (std::ostream *os = target->stream())
+            {
+                return *os << value;
+            }
+            if (!buffer)
+            {
+                buffer = std::make_unique<std::ostringstream>();
+            }
+            return *buffer << value;
+        }
+    };
+
+    /**
+     * Applies the style preset referred to by `preset` to the output stream.
+     *
+     * @param preset The handle of the style preset to apply.
+     * @param target The target to write to (default: `defaultTarget()`).
+     * @return A `StyledCout` object that can be used to chain additional styling or output operations.
+     */
+    inline StyledCout style(PresetHandle preset, OutputTarget &target = defaultTarget())
+    {
+        return StyledCout(detail::sharedPreset(preset, target.colorSupport()), target);
+    }
+
+    /**
+     * Applies a compile-time style to the output stream, followed by a restore code and a new line.
+     *
+     * @param style The compile-time style to apply, e.g. `static_style<Codes::BRIGHT>`.
+     * @param target The target to write to (default: `defaultTarget()`).
+     * @return A `StyledCout` object that can be used to chain additional styling or output operations.
+     */
+    template<std::size_t N>
+    StyledCout style(const StaticSequence<N> &style, OutputTarget &target = defaultTarget())
+    {
+        if (target.colorSupport() == ColorSupport::NONE)
+        {
+            return StyledCout({}, "\n", target);
+        }
+        return StyledCout(style.view(), static_suffix.view(), target);
+    }
+
+    /**
+     * Applies a specific style preset to the output stream.
+     *
+     * @param preset The name of the style preset to apply.
+     * @param target The target to write to (default: `defaultTarget()`).
+     * @return A `StyledCout` object that can be used to chain additional styling or output operations.
+     */
+    inline StyledCout style(std::string_view preset, OutputTarget &target = defaultTarget())
+    {
+        return style(getPresetHandle(preset), target);
+    }
+
+    /**
+     * @brief Enum class for the flush policies of `StyledWriter`.
+     */
+    enum class FlushPolicy : int
+    {
+        /** Flush after every printed line. */
+        LINE = 0,
+        /** Flush when the buffered output reaches the size threshold. */
+        SIZE = 1,
+        /** Flush only when `flush()` is called or the writer is destroyed. */
+        EXPLICIT = 2
+    };
+
+    /**
+     * @brief A buffered sink that assembles styled lines and emits them with a single write.
+     *
+     * Where `print()` hands each line to its target separately, a `StyledWriter` copies the prefix, the text
+     * and the suffix into its buffer and passes the whole buffer to the target in one call when flushed.
+     * With an `FdTarget` this is a single system call, so lines never interleave and fewer system calls are made.
+     *
+     * With state tracking enabled (`setStateTracking()`), the writer remembers the SGR state its output leaves
+     * the terminal in and only emits the attributes that change, so consecutive lines sharing a style are written
+     * without any escape sequence between them.
+     *
+     * A writer is not meant to be shared between threads. Use `threadWriter()` to get one per thread.
+     */
+    class StyledWriter
+    {
+    private:
+        /**
+         * The target used when constructed from a file descriptor.
+        */
+        std::unique_ptr<FdTarget> owned_target;
+
+        /**
+         * The target to write to.
+        */
+        OutputTarget *target;
+
+        /**
+         * @see FlushPolicy
+        */
+        FlushPolicy policy;
+
+        /**
+         * The buffer size that triggers a flush under `FlushPolicy::SIZE`.
+        */
+        std::size_t threshold;
+
+        /**
+         * The buffered output.
+        */
+        std::string buffer;
+
+        /**
+         * Whether the terminal state is tracked.
+        */
+        bool tracking = false;
+
+        /**
+         * The state the buffered output leaves the terminal in.
+        */
+        SgrState actual;
+
+        /**
+         * The state the next text should be shown in. Switching to it is deferred until that text is written.
+        */
+        SgrState wanted;
+
+        void lineDone()
+        {
+            if (policy == FlushPolicy::LINE || (policy == FlushPolicy::SIZE && buffer.size() >= threshold))
+            {
+                flush();
+            }
+        }
+
+        void append(std::string_view prefix, std::string_view text, std::string_view suffix)
+        {
+            buffer.append(prefix.data(), prefix.size());
+            buffer.append(text.data(), text.size());
+            buffer.append(suffix.data(), suffix.size());
+            lineDone();
+        }
+
+        void switchTo(const SgrState &state)
+        {
+            detail::StringSink sink{buffer};
+            detail::renderTransition(sink, actual, state);
+            actual = state;
+        }
+
+        void show(std::string_view text)
+        {
+            if (text.empty()) return;
+            switchTo(wanted);
+            buffer.append(text.data(), text.size());
+        }
+
+        void appendTracked(const CompiledPreset &compiled, std::string_view text)
+        {
+            wanted.apply(compiled.prefix_styles);
+            show(compiled.prefix_text);
+            wanted.apply(compiled.text_styles);
+            show(text);
+            wanted.apply(compiled.suffix_styles);
+            show(compiled.suffix_text);
+            wanted.apply(compiled.end_styles);
+            if (compiled.trailing_newline)
+            {
+                // Only the background and reverse video show on the new line, so every other style is
+                // carried over it and switched off only if the next line does not use it.
+                const std::uint16_t reverse = 1u << static_cast<int>(Codes::REVERSE);
+                SgrState carried = actual;
+                carried.background = wanted.background;
+                carried.attributes = static_cast<std::uint16_t>((actual.attributes & ~reverse) | (wanted.attributes & reverse));
+                switchTo(carried);
+                buffer.push_back('\n');
+            }
+            lineDone();
+        }
+
+    public:
+        /**
+         * @brief Constructs a `StyledWriter` that writes to `target`.
+         *
+         * @param target The target to write to.
+         * @param policy The flush policy (default: `FlushPolicy::LINE`).
+         * @param threshold The buffer size that triggers a flush under `FlushPolicy::SIZE`.
+         */
+        explicit StyledWriter(OutputTarget &target, FlushPolicy policy = FlushPolicy::LINE, std::size_t threshold = 4096)
+            : target(&target), policy(policy), threshold(threshold)
+        {
+            buffer.reserve(threshold);
+        }
+
+        /**
+         * @brief Constructs a `StyledWriter` that writes to a file descriptor.
+         *
+         * @param fd The file descriptor to write to (default: standard output).
+         * @param policy The flush policy (default: `FlushPolicy::LINE`).
+         * @param threshold The buffer size that triggers a flush under `FlushPolicy::SIZE`.
+         */
+        explicit StyledWriter(int fd = 1, FlushPolicy policy = FlushPolicy::LINE, std::size_t threshold = 4096)
+            : owned_target(std::make_unique<FdTarget>(fd)), target(owned_target.get()), policy(policy), threshold(threshold)
+        {
+            buffer.reserve(threshold);
+        }
+
+        StyledWriter(const StyledWriter &) = delete;
+        StyledWriter &operator=(const StyledWriter &) = delete;
+
+        ~StyledWriter()
+        {
+            if (tracking)
+            {
+                switchTo(wanted);
+            }
+            flush();
+        }
+
+        /**
+         * @brief Changes the flush policy. Does not flush by itself.
+         */
+        void setFlushPolicy(FlushPolicy new_policy, std::size_t new_threshold = 4096)
+        {
+            policy = new_policy;
+            threshold = new_threshold;
+        }
+
+        /**
+         * Buffers the specified text styled with the preset referred to by `preset`.
+         *
+         * @param preset The handle of the preset style to apply to the text.
+         * @param text   The text to be printed.
+         */
+        void print(PresetHandle preset, std::string_view text = "")
+        {
+            const CompiledPreset &compiled = getCompiledPreset(preset, target->colorSupport());
+            if (tracking)
+            {
+                appendTracked(compiled, text);
+                return;
+            }
+            append(compiled.prefix, text, compiled.suffix);
+        }
+
+        /**
+         * Buffers the specified text styled with the given preset.
+         *
+         * @param preset The name of the preset style to apply to the text.
+         * @param text   The text to be printed.
+         */
+        void print(std::string_view preset, std::string_view text = "")
+        {
+            print(getPresetHandle(preset), text);
+        }
+
+        /**
+         * Buffers the specified text styled with a compile-time style, followed by a restore code and a new line.
+         *
+         * @param style The compile-time style to apply to the text.
+         * @param text  The text to be printed.
+         */
+        template<std::size_t N>
+        void print(const StaticSequence<N> &style, std::string_view text = "")
+        {
+            if (target->colorSupport() == ColorSupport::NONE)
+            {
+                append({}, text, "\n");
+                return;
+            }
+            if (tracking)
+            {
+                // The sequence is opaque, so apply it on top of the expected state and restore afterwards.
+                switchTo(wanted);
+                actual = wanted = SgrState();
+            }
+            append(style.view(), text, static_suffix.view());
+        }
+
+        /**
+         * Buffers the formatted arguments styled with the preset referred to by `preset`.
+         * Without state tracking, they are formatted straight into the buffer.
+         *
+         * @param preset The handle of the preset style to apply to the text.
+         * @param fmt    The format string, e.g. `"x={} y={}"`.
+         * @param args   The arguments to format.
+         */
+        template<typename Arg, typename... Args>
+        void print(PresetHandle preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+        {
+            const ColorSupport support = target->colorSupport();
+            const CompiledPreset &compiled = getCompiledPreset(preset, support);
+            if (tracking)
+            {
+                SgrState around = wanted;
+                around.apply(compiled.prefix_styles);
+                around.apply(compiled.text_styles);
+                const detail::FormatScope scope(support, around);
+                std::string &text = detail::lineBuffer();
+                detail::formatTo<Arg, Args...>(text, fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+                appendTracked(compiled, text);
+                return;
+            }
+            const detail::FormatScope scope(support, compiled.text_state);
+            buffer.append(compiled.prefix);
+            detail::formatTo<Arg, Args...>(buffer, fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+            buffer.append(compiled.suffix);
+            lineDone();
+        }
+
+        /**
+         * Buffers the formatted arguments styled with the given preset.
+         *
+         * @param preset The name of the preset style to apply to the text.
+         * @param fmt    The format string, e.g. `"x={} y={}"`.
+         * @param args   The arguments to format.
+         */
+        template<typename Arg, typename... Args>
+        void print(std::string_view preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+        {
+            print<Arg, Args...>(getPresetHandle(preset), fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+        }
+
+        /**
+         * Buffers a styled text. Unlike presets, no new line is added.
+         *
+         * @param text The styled text to print.
+         */
+        void print(const StyledText &text)
+        {
+            const ColorSupport support = target->colorSupport();
+            if (!tracking)
+            {
+                detail::StringSink sink{buffer};
+                detail::renderStyle(sink, text, support);
+                lineDone();
+                return;
+            }
+            const std::string_view str = text.text();
+            for (const StyledText::Span &span : text.spans())
+            {
+                wanted = detail::downgradeState(span.style, support);
+                show(str.substr(span.offset, span.length));
+            }
+            wanted = SgrState();
+            lineDone();
+        }
+
+        /**
+         * @brief Enables or disables tracking of the terminal state.
+         *
+         * While tracking, the restore codes and repeated styles of consecutive lines are left out, and the
+         * remaining styles of each boundary are merged into a single escape sequence. Tracking assumes that
+         * the terminal starts in its default state and that nothing else writes to it in the meantime;
+         * call `resetState()` otherwise. Disabling it emits any deferred change first.
+         *
+         * @param enabled Whether to track the terminal state.
+         */
+        void setStateTracking(bool enabled)
+        {
+            if (tracking && !enabled)
+            {
+                switchTo(wanted);
+            }
+            tracking = enabled;
+        }
+
+        /**
+         * @brief Writes a restore code and forgets the tracked state.
+         *
+         * Call this after something other than this writer has written to the terminal.
+         */
+        void resetState()
+        {
+            if (target->colorSupport() != ColorSupport::NONE)
+            {
+                buffer.append(static_style<Codes::RESTORE>.view());
+            }
+            actual = wanted = SgrState();
+            lineDone();
+        }
+
+        /**
+         * Passes all buffered output to the target in a single write.
+         */
+        void flush()
+        {
+            if (buffer.empty()) return;
+            target->write(buffer);
+            buffer.clear();
+        }
+    };
+
+    /**
+     * @brief Returns the calling thread's `StyledWriter` for standard output.
+     *
+     * The writer is flushed when the thread exits.
+     */
+    inline StyledWriter &threadWriter()
+    {
+        thread_local StyledWriter writer;
+        return writer;
+    }
+
+    /** @} */
+
+    /**
+     * @defgroup Screen_group Screen Buffers
+     * Content related to drawing full-screen interfaces and redrawing only the cells that change.
+     * @{
+     */
+
+    /**
+     * @brief One character cell of a `ScreenBuffer`: a UTF-8 character and the style it is shown in.
+     *
+     * The fields leave no padding, so cells and whole rows compare with `memcmp()`.
+     */
+    struct Cell
+    {
+        /**
+         * The UTF-8 bytes of the character, padded with zeros.
+        */
+        char glyph[4] = {' ', 0, 0, 0};
+        Color foreground = Color(Codes::FOREGROUND_RESET);
+        Color background = Color(Codes::BACKGROUND_RESET);
+        /**
+         * The active attributes, as in `SgrState`.
+        */
+        std::uint32_t attributes = 0;
+
+        SgrState style() const noexcept
+        {
+            SgrState state;
+            state.attributes = static_cast<std::uint16_t>(attributes);
+            state.foreground = foreground;
+            state.background = background;
+            return state;
+        }
+
+        void setStyle(const SgrState &state) noexcept
+        {
+            attributes = state.attributes;
+            foreground = state.foreground;
+            background = state.background;
+        }
+    };
+
+    static_assert(sizeof(Cell) == 16 && std::is_trivially_copyable_v<Cell>, "Cell has no padding");
+
+    inline bool operator==(const Cell &a, const Cell &b) noexcept
+    {
+        return std::memcmp(&a, &b, sizeof(Cell)) == 0;
+    }
+
+    inline bool operator!=(const Cell &a, const Cell &b) noexcept
+    {
+        return !(a == b);
+    }
+
+    namespace detail
+    {
+        /**
+         * Collects small writes on the stack and appends them to a string in large blocks.
+         * `finish()` appends what is left.
+        */
+        struct BlockSink
+        {
+            std::string &str;
+            char block[4096];
+            std::size_t used = 0;
+
+            explicit BlockSink(std::string &str) noexcept : str(str) {}
+
+            void put(const char *data, std::size_t size)
+            {
+                if (used + size > sizeof(block))
+                {
+                    str.append(block, used);
+                    used = 0;
+                    if (size > sizeof(block))
+                    {
+                        str.append(data, size);
+                        return;
+                    }
+                }
+                std::memcpy(block + used, data, size);
+                used += size;
+            }
+
+            void finish()
+            {
+                str.append(block, used);
+                used = 0;
+            }
+        };
+
+        inline std::size_t glyphLength(const char (&glyph)[4]) noexcept
+        {
+            std::size_t length = 1;
+            while (length < 4 && glyph[length] != 0) length++;
+            return length;
+        }
+
+        /**
+         * The style a cell is shown in with the given color support.
+        */
+        inline SgrState shownStyle(const Cell &cell, ColorSupport support)
+        {
+            if (support == ColorSupport::COLRGB) return cell.style();
+            return downgradeState(cell.style(), support);
+        }
+    } // namespace detail
+
+    /**
+     * @brief A grid of cells drawn off screen and written to the terminal as the difference to the last frame.
+     *
+     * Drawing goes to a back buffer. `flush()` compares it with a front buffer holding what the terminal shows,
+     * and writes only the cells that changed, in a single write: it moves the cursor over unchanged cells,
+     * switches styles with the shortest transition and ends in the default state. The first flush, and the
+     * first after `invalidate()` or `resize()`, clears the screen and draws every cell that is not blank.
+     *
+     * Every character takes one cell, so wide characters are not supported.
+     */
+    class ScreenBuffer
+    {
+    private:
+        std::size_t cols;
+        std::size_t rows;
+        std::vector<Cell> back;
+        std::vector<Cell> front;
+        bool valid = false;
+        std::string frame;
+
+        static constexpr std::size_t unknown = static_cast<std::size_t>(-1);
+
+        template<typename Sink>
+        static void moveTo(Sink &sink, std::size_t row, std::size_t col)
+        {
+            char buf[48];
+            char *end = buf;
+            *end++ = '\033';
+            *end++ = '[';
+            end = detail::writeInt(end, static_cast<int>(row + 1));
+            *end++ = ';';
+            end = detail::writeInt(end, static_cast<int>(col + 1));
+            *end++ = 'H';
+            sink.put(buf, static_cast<std::size_t>(end - buf));
+        }
+
+        /**
+         * Moves the cursor from (`cx`, `cy`) to (`x`, `y`) the shortest way: rewriting the unchanged cells
+         * in between if they are shown in the current style, moving forward, a new line, or an absolute move.
+        */
+        template<typename Sink>
+        void moveCursor(Sink &sink, std::size_t cx, std::size_t cy, std::size_t x, std::size_t y,
+                        const SgrState &current, ColorSupport support)
+        {
+            if (cy == y && cx == x) return;
+            if (cy == y && cx != unknown && x > cx)
+            {
+                const std::size_t gap = x - cx;
+                const std::size_t forward = gap == 1 ? 3 : 3 + detail::intLength(static_cast<int>(gap));
+                std::size_t rewrite = 0;
+                for (std::size_t i = cx; i < x && rewrite <= forward; i++)
+                {
+                    const Cell &cell = front[y * cols + i];
+                    rewrite += detail::shownStyle(cell, support) == current ? detail::glyphLength(cell.glyph) : forward + 1;
+                }
+                if (rewrite <= forward)
+                {
+                    for (std::size_t i = cx; i < x; i++)
+                    {
+                        const Cell &cell = front[y * cols + i];
+                        sink.put(cell.glyph, detail::glyphLength(cell.glyph));
+                    }
+                }
+                else if (gap == 1)
+                {
+                    sink.put("\033[C", 3);
+                }
+                else
+                {
+                    char buf[24];
+                    char *end = buf;
+                    *end++ = '\033';
+                    *end++ = '[';
+                    end = detail::writeInt(end, static_cast<int>(gap));
+                    *end++ = 'C';
+                    sink.put(buf, static_cast<std::size_t>(end - buf));
+                }
+            }
+            else if (x == 0 && cy != unknown && y == cy + 1)
+            {
+                sink.put("\r\n", 2);
+            }
+            else
+            {
+                moveTo(sink, y, x);
+            }
+        }
+
+    public:
+        /**
+         * @brief Constructs a screen of blank cells.
+         *
+         * @param width The number of columns.
+         * @param height The number of rows.
+         */
+        ScreenBuffer(std::size_t width, std::size_t height)
+            : cols(width), rows(height), back(width * height), front(width * height) {}
+
+        std::size_t width() const noexcept
+        {
+            return cols;
+        }
+
+        std::size_t height() const noexcept
+        {
+            return rows;
+        }
+
+        /**
+         * @brief Returns the cell at column `x` of row `y` of the back buffer.
+         */
+        Cell &at(std::size_t x, std::size_t y) noexcept
+        {
+            return back[y * cols + x];
+        }
+
+        const Cell &at(std::size_t x, std::size_t y) const noexcept
+        {
+            return back[y * cols + x];
+        }
+
+        /**
+         * @brief Fills the back buffer with blank cells.
+         *
+         * @param style The style of the blank cells, e.g. to paint a background color.
+         */
+        void clear(const SgrState &style = SgrState()) noexcept
+        {
+            Cell blank;
+            blank.setStyle(style);
+            std::fill(back.begin(), back.end(), blank);
+        }
+
+        /**
+         * @brief Writes `text` into a row of the back buffer, one UTF-8 character per cell.
+         *
+         * @param x The column of the first character.
+         * @param y The row.
+         * @param text The text to write. It is cut off at the edge of the screen.
+         * @param style The style of the text.
+         * @return The column after the last character written.
+         */
+        std::size_t put(std::size_t x, std::size_t y, std::string_view text, const SgrState &style = SgrState()) noexcept
+        {
+            if (y >= rows) return x;
+            Cell styled;
+            styled.setStyle(style);
+            for (std::size_t i = 0; i < text.size() && x < cols; x++)
+            {
+                Cell &cell = back[y * cols + x];
+                cell = styled;
+                cell.glyph[0] = text[i];
+                cell.glyph[1] = 0;
+                std::size_t length = 1;
+                while (i + length < text.size() && (static_cast<unsigned char>(text[i + length]) & 0xC0) == 0x80)
+                {
+                    if (length < sizeof(cell.glyph)) cell.glyph[length] = text[i + length];
+                    length++;
+                }
+                i += length;
+            }
+            return x;
+        }
+
+        /**
+         * @brief Changes the size of the screen. The back buffer is cleared and the next flush redraws everything.
+         */
+        void resize(std::size_t width, std::size_t height)
+        {
+            cols = width;
+            rows = height;
+            back.assign(width * height, Cell());
+            front.assign(width * height, Cell());
+            valid = false;
+        }
+
+        /**
+         * @brief Makes the next flush redraw the whole screen, e.g. after other output overwrote it.
+         */
+        void invalidate() noexcept
+        {
+            valid = false;
+        }
+
+        /**
+         * @brief Appends the output that brings the terminal from the last frame to the back buffer to `out`,
+         * and records the back buffer as shown.
+         *
+         * @param out The string to append to. It only allocates if its capacity is exceeded.
+         * @return The number of bytes appended.
+         */
+        std::size_t render(std::string &out)
+        {
+            return render(out, getColorSupport());
+        }
+
+        /**
+         * @brief Renders the cells that changed since the last frame for a terminal with the given color support.
+         *
+         * @param out The string to append to.
+         * @param support The color support to render for.
+         * @return The number of bytes appended.
+         */
+        std::size_t render(std::string &out, ColorSupport support)
+        {
+            const std::size_t start = out.size();
+            detail::BlockSink sink{out};
+            if (!valid)
+            {
+                sink.put("\033[0m\033[2J", 8);
+                std::fill(front.begin(), front.end(), Cell());
+                valid = true;
+            }
+
+            SgrState current;
+            std::size_t cx = unknown, cy = unknown;
+            for (std::size_t y = 0; y < rows; y++)
+            {
+                if (std::memcmp(back.data() + y * cols, front.data() + y * cols, cols * sizeof(Cell)) == 0) continue;
+                for (std::size_t x = 0; x < cols; x++)
+                {
+                    const Cell &cell = back[y * cols + x];
+                    Cell &shown = front[y * cols + x];
+                    if (cell == shown) continue;
+
+                    moveCursor(sink, cx, cy, x, y, current, support);
+                    const SgrState style = detail::shownStyle(cell, support);
+                    if (style != current)
+                    {
+                        detail::renderTransition(sink, current, style);
+                        current = style;
+                    }
+                    sink.put(cell.glyph, cell.glyph[1] == 0 ? 1 : detail::glyphLength(cell.glyph));
+                    shown = cell;
+                    // The cursor stays on the last column, but the next character would wrap.
+                    cx = x + 1 == cols ? unknown : x + 1;
+                    cy = y;
+                }
+            }
+            detail::renderTransition(sink, current, SgrState());
+            sink.finish();
+            return out.size() - start;
+        }
+
+        /**
+         * @brief Writes the cells that changed since the last frame to `out` in a single write, and flushes it.
+         *
+         * @param out The target to write to.
+         * @return The number of bytes written.
+         */
+        std::size_t flush(OutputTarget &out)
+        {
+            frame.clear();
+            const std::size_t size = render(frame, out.colorSupport());
+            if (size != 0)
+            {
+                out.write(frame);
+                out.flush();
+            }
+            return size;
+        }
+
+        /**
+         * @brief Writes the cells that changed since the last frame to the default target in a single write.
+         */
+        std::size_t flush()
+        {
+            return flush(defaultTarget());
+        }
+    };
+
+    /** @} */ // end of Screen_group
+
+    /**
+     * @defgroup Export_group Exporting
+     * Content related to converting styled output into HTML and SVG documents.
+     * @{
+     */
+
+    /**
+     * @brief The document formats an `Exporter` writes.
+     */
+    enum class ExportFormat
+    {
+        /**
+         * A page with the output in a `<pre>` element, styled with CSS classes.
+        */
+        HTML,
+        /**
+         * An image with one `<text>` element per run of text on a grid of character cells.
+        */
+        SVG
+    };
+
+    namespace detail
+    {
+        /** The colors exported documents show for the terminal's default foreground and background. */
+        constexpr ColRGB export_foreground = paletteColor(7);
+        constexpr ColRGB export_background = paletteColor(0);
+
+        /** The SVG grid: 14px monospace characters are about 8.4px wide, and lines are 17px apart. */
+        constexpr std::size_t export_cell_tenths = 84;
+        constexpr std::size_t export_line_height = 17;
+        constexpr std::size_t export_baseline = 13;
+
+        /**
+         * A number that identifies a state: the type and payload of both colors take 26 bits each,
+         * followed by the attributes.
+        */
+        inline std::uint64_t exportKey(const SgrState &state) noexcept
+        {
+            auto key = [](Color col) -> std::uint64_t {
+                std::uint64_t payload;
+                switch (col.type())
+                {
+                case ColorType::COL16:
+                    payload = static_cast<std::uint64_t>(col.col16());
+                    break;
+                case ColorType::COL256:
+                    payload = static_cast<std::uint64_t>(col.col256().ID);
+                    break;
+                default:
+                    const ColRGB rgb = col.colrgb();
+                    payload = static_cast<std::uint64_t>(rgb.r) << 16 | static_cast<std::uint64_t>(rgb.g) << 8
+                              | static_cast<std::uint64_t>(rgb.b);
+                }
+                return static_cast<std::uint64_t>(col.type()) << 24 | payload;
+            };
+            return key(state.foreground) | key(state.background) << 26 | static_cast<std::uint64_t>(state.attributes) << 52;
+        }
+
+        /**
+         * The RGB value a color is shown in. Returns false for the terminal's default colors.
+        */
+        inline bool exportColor(Color col, ColRGB &rgb) noexcept
+        {
+            if (col.type() == ColorType::COL16)
+            {
+                const int code = static_cast<int>(col.col16());
+                if (code >= 30 && code <= 37)
+                {
+                    rgb = paletteColor(code - 30);
+                    return true;
+                }
+                if (code >= 40 && code <= 47)
+                {
+                    rgb = paletteColor(code - 40);
+                    return true;
+                }
+                return false;
+            }
+            rgb = col.type() == ColorType::COL256 ? paletteColor(col.col256().ID) : col.colrgb();
+            return true;
+        }
+
+        inline void appendHexColor(std::string &out, const ColRGB &rgb)
+        {
+            constexpr char digits[] = "0123456789abcdef";
+            const char hex[7] = {'#', digits[rgb.r >> 4], digits[rgb.r & 15], digits[rgb.g >> 4],
+                                 digits[rgb.g & 15], digits[rgb.b >> 4], digits[rgb.b & 15]};
+            out.append(hex, sizeof(hex));
+        }
+
+        /**
+         * Appends a length given in tenths of a pixel, e.g. `84` as `8.4`.
+        */
+        inline void appendTenths(std::string &out, std::size_t tenths)
+        {
+            char buf[24];
+            char *end = std::to_chars(buf, buf + sizeof(buf), tenths / 10).ptr;
+            if (tenths % 10 != 0)
+            {
+                *end++ = '.';
+                *end++ = static_cast<char>('0' + tenths % 10);
+            }
+            out.append(buf, static_cast<std::size_t>(end - buf));
+        }
+
+        /**
+         * Bytes that cannot be copied into markup as they are: `&`, `<`, `>` and control characters,
+         * which are not allowed in XML. New lines and tabs are copied.
+        */
+        struct MarkupSpecial
+        {
+            bool table[256] = {};
+
+            constexpr MarkupSpecial() noexcept
+            {
+                for (int c = 0; c < 0x20; c++)
+                {
+                    table[c] = c != '\n' && c != '\t';
+                }
+                table[static_cast<unsigned char>('&')] = true;
+                table[static_cast<unsigned char>('<')] = true;
+                table[static_cast<unsigned char>('>')] = true;
+            }
+        };
+
+        constexpr MarkupSpecial markup_special{};
+
+        /**
+         * Appends text to markup, escaping `&`, `<` and `>` and dropping other control characters.
+        */
+        inline void appendEscaped(std::string &out, std::string_view text)
+        {
+            const char *pos = text.data();
+            const char *const last = pos + text.size();
+            while (pos != last)
+            {
+                const char *run = pos;
+                while (pos != last && !markup_special.table[static_cast<unsigned char>(*pos)]) pos++;
+                out.append(run, static_cast<std::size_t>(pos - run));
+                if (pos == last) break;
+                switch (*pos++)
+                {
+                case '&':
+                    out.append("&amp;", 5);
+                    break;
+                case '<':
+                    out.append("&lt;", 4);
+                    break;
+                case '>':
+                    out.append("&gt;", 4);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief Converts styled output, such as a captured log, into an HTML or SVG document.
+     *
+     * Output is decoded with an `SgrDecoder` and written to a target as it arrives, so logs of any size convert
+     * with constant memory: only the styles seen so far are kept. Each distinct style becomes one CSS class,
+     * declared in a `<style>` element just before its first use, and text is wrapped in elements of that class
+     * rather than carrying inline styles. Classes are numbered (`ts1`, `ts2`, ...) unless named with `nameStyle()`
+     * or `namePreset()`, which gives the text of a preset the class `ts-<name>` and its prefix and suffix
+     * `ts-<name>-prefix` and `ts-<name>-suffix`.
+     *
+     * 16-color codes and `Col256` colors are shown in the xterm palette, and `ColRGB` colors as they are.
+     * Bright, dim, italic, underline, reverse, hidden and strike are exported; flash is not.
+     * SVG documents lay text out on a grid with one cell per UTF-8 character and tab stops every 8 columns.
+     *
+     * @code
+     * ts::FdTarget html(fd);
+     * ts::Exporter exporter(html);
+     * exporter.namePreset("warn");
+     * while ((n = read(log, buf, sizeof(buf))) > 0) exporter.feed({buf, n});
+     * exporter.finish();
+     * @endcode
+     */
+    class Exporter
+    {
+    private:
+        struct Style
+        {
+            std::string name;
+            bool declared = false;
+            /** Whether the SVG rule for the background of the class was declared. */
+            bool background = false;
+        };
+
+        OutputTarget &target;
+        ExportFormat format;
+        SgrDecoder decoder;
+        std::string buffer;
+        std::unordered_map<std::uint64_t, Style> styles;
+        std::size_t numbered = 0;
+        bool started = false;
+
+        const std::uint64_t default_key = detail::exportKey(SgrState());
+        /** The style of the last run, and in HTML the class of the open `<span>`. */
+        std::uint64_t last_key = default_key;
+        Style *last_style = nullptr;
+
+        /** The SVG cursor, the widest line so far, and the text of the last style not yet written at the cursor. */
+        std::size_t line = 0, column = 0, columns = 0;
+        std::string piece;
+
+        /** Output is passed on to the target in blocks of about this size. */
+        static constexpr std::size_t block_size = 1 << 16;
+
+        void spill()
+        {
+            if (buffer.size() >= block_size)
+            {
+                target.write(buffer);
+                buffer.clear();
+            }
+        }
+
+        void begin()
+        {
+            started = true;
+            if (format == ExportFormat::HTML)
+            {
+                buffer += "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<style>\npre.termstyle{background:";
+                detail::appendHexColor(buffer, detail::export_background);
+                buffer += ";color:";
+                detail::appendHexColor(buffer, detail::export_foreground);
+                // The new line after <pre> is dropped by browsers, so that the output keeps its first line.
+                buffer += ";font-family:monospace;padding:1em}\n</style>\n</head>\n<body>\n<pre class=\"termstyle\">\n";
+            }
+            else
+            {
+                buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                          "class=\"termstyle\" font-family=\"monospace\" font-size=\"14\" xml:space=\"preserve\">\n"
+                          "<style>svg.termstyle{background:";
+                detail::appendHexColor(buffer, detail::export_background);
+                buffer += "}text{fill:";
+                detail::appendHexColor(buffer, detail::export_foreground);
+                buffer += "}</style>\n";
+            }
+        }
+
+        /**
+         * Returns the class of a state that is not the default, declaring it on first use.
+        */
+        Style &use(std::uint64_t key, const SgrState &state)
+        {
+            Style &style = styles[key];
+            if (style.name.empty())
+            {
+                style.name = "ts" + std::to_string(++numbered);
+            }
+            if (!style.declared)
+            {
+                declare(style, state);
+            }
+            return style;
+        }
+
+        void declare(Style &style, const SgrState &state)
+        {
+            ColRGB fg = detail::export_foreground, bg = detail::export_background;
+            bool has_fg = detail::exportColor(state.foreground, fg);
+            bool has_bg = detail::exportColor(state.background, bg);
+            if (state.attributes & (1u << static_cast<int>(Codes::REVERSE)))
+            {
+                const ColRGB shown_bg = has_fg ? fg : detail::export_foreground;
+                fg = has_bg ? bg : detail::export_background;
+                bg = shown_bg;
+                has_fg = has_bg = true;
+            }
+            const bool html = format == ExportFormat::HTML;
+            buffer += "<style>.";
+            buffer += style.name;
+            buffer += '{';
+            if (has_fg)
+            {
+                buffer += html ? "color:" : "fill:";
+                detail::appendHexColor(buffer, fg);
+                buffer += ';';
+            }
+            if (has_bg && html)
+            {
+                buffer += "background-color:";
+                detail::appendHexColor(buffer, bg);
+                buffer += ';';
+            }
+            auto has = [&state](Codes code) {
+                return (state.attributes & (1u << static_cast<int>(code))) != 0;
+            };
+            if (has(Codes::BRIGHT)) buffer += "font-weight:bold;";
+            if (has(Codes::DIM)) buffer += "opacity:0.5;";
+            if (has(Codes::ITALIC)) buffer += "font-style:italic;";
+            if (has(Codes::UNDERLINE) || has(Codes::STRIKE))
+            {
+                buffer += "text-decoration:";
+                buffer += has(Codes::UNDERLINE) ? (has(Codes::STRIKE) ? "underline line-through" : "underline") : "line-through";
+                buffer += ';';
+            }
+            if (has(Codes::HIDDEN)) buffer += "visibility:hidden;";
+            buffer += '}';
+            if (has_bg && !html)
+            {
+                buffer += '.';
+                buffer += style.name;
+                buffer += "-bg{fill:";
+                detail::appendHexColor(buffer, bg);
+                buffer += '}';
+            }
+            buffer += "</style>";
+            style.declared = true;
+            style.background = has_bg && !html;
+        }
+
+        void html(std::string_view text, const SgrState &state)
+        {
+            const std::uint64_t key = detail::exportKey(state);
+            if (key != last_key)
+            {
+                if (last_key != default_key) buffer += "</span>";
+                if (key != default_key)
+                {
+                    const Style &style = use(key, state);
+                    buffer += "<span class=\"";
+                    buffer += style.name;
+                    buffer += "\">";
+                }
+                last_key = key;
+            }
+            // Long runs are escaped in blocks, so that the buffer stays small however large the chunks are.
+            while (text.size() > block_size)
+            {
+                detail::appendEscaped(buffer, text.substr(0, block_size));
+                text.remove_prefix(block_size);
+                spill();
+            }
+            detail::appendEscaped(buffer, text);
+            spill();
+        }
+
+        /**
+         * Writes one piece of a line, without new lines or tabs, at the cursor.
+        */
+        void svgText(std::string_view text, const Style *style)
+        {
+            const std::size_t width = visible_width(text);
+            if (style && style->background)
+            {
+                svgRect(width, style);
+            }
+            if (text.find_first_not_of(' ') != std::string_view::npos)
+            {
+                buffer += style ? "<text class=\"" : "<text";
+                if (style)
+                {
+                    buffer += style->name;
+                    buffer += '"';
+                }
+                buffer += " x=\"";
+                detail::appendTenths(buffer, column * detail::export_cell_tenths);
+                buffer += "\" y=\"";
+                detail::appendTenths(buffer, (line * detail::export_line_height + detail::export_baseline) * 10);
+                buffer += "\">";
+                detail::appendEscaped(buffer, text);
+                buffer += "</text>\n";
+            }
+            column += width;
+            columns = std::max(columns, column);
+            spill();
+        }
+
+        void svgRect(std::size_t width, const Style *style)
+        {
+            buffer += "<rect class=\"";
+            buffer += style->name;
+            buffer += "-bg\" x=\"";
+            detail::appendTenths(buffer, column * detail::export_cell_tenths);
+            buffer += "\" y=\"";
+            detail::appendTenths(buffer, line * detail::export_line_height * 10);
+            buffer += "\" width=\"";
+            detail::appendTenths(buffer, width * detail::export_cell_tenths);
+            buffer += "\" height=\"";
+            detail::appendTenths(buffer, detail::export_line_height * 10);
+            buffer += "\"/>\n";
+        }
+
+        /**
+         * Writes the text collected at the cursor. With `partial`, a character cut off at the end is kept.
+        */
+        void writePiece(bool partial = false)
+        {
+            std::size_t size = piece.size();
+            if (partial)
+            {
+                while (size > 0 && (static_cast<unsigned char>(piece[size - 1]) & 0xC0) == 0x80) size--;
+                if (size > 0 && static_cast<unsigned char>(piece[size - 1]) >= 0xC0) size--;
+            }
+            if (size == 0) return;
+            svgText(std::string_view(piece.data(), size), last_style);
+            piece.erase(0, size);
+        }
+
+        void svg(std::string_view text, const SgrState &state)
+        {
+            const std::uint64_t key = detail::exportKey(state);
+            if (key != last_key)
+            {
+                writePiece();
+                last_style = key == default_key ? nullptr : &use(key, state);
+                last_key = key;
+            }
+            // Text is collected until the style, the line or the column changes, so that the document
+            // does not depend on how the output was split, and characters are never split between elements.
+            while (!text.empty())
+            {
+                std::size_t end = 0;
+                while (end < text.size() && text[end] != '\n' && text[end] != '\t') end++;
+                piece.append(text.data(), end);
+                if (piece.size() > block_size)
+                {
+                    writePiece(true);
+                }
+                if (end == text.size()) break;
+                writePiece();
+                if (text[end] == '\n')
+                {
+                    line++;
+                    column = 0;
+                }
+                else
+                {
+                    const std::size_t stop = (column / 8 + 1) * 8;
+                    if (last_style && last_style->background)
+                    {
+                        svgRect(stop - column, last_style);
+                    }
+                    column = stop;
+                    columns = std::max(columns, column);
+                }
+                text.remove_prefix(end + 1);
+            }
+        }
+
+    public:
+        /**
+         * @brief Constructs an exporter that writes a document to `target`.
+         *
+         * @param target The target to write to. Must outlive the exporter.
+         * @param format The format of the document.
+         */
+        explicit Exporter(OutputTarget &target, ExportFormat format = ExportFormat::HTML)
+            : target(target), format(format)
+        {
+            buffer.reserve(block_size + 4096);
+        }
+
+        Exporter(const Exporter &) = delete;
+        Exporter &operator=(const Exporter &) = delete;
+
+        /**
+         * Finishes the document, if anything was fed since the last `finish()`.
+        */
+        ~Exporter()
+        {
+            if (started)
+            {
+                finish();
+            }
+        }
+
+        /**
+         * @brief Gives the class of a state a name, so that the document reads `ts-<name>` instead of a number.
+         *
+         * Characters other than letters, digits, `-` and `_` are replaced with `-`. A state keeps the first name
+         * it is given, and the default state has no class, so name styles before feeding the output they appear in.
+         *
+         * @param name The name of the class, without the `ts-` prefix.
+         * @param state The state shown in the class.
+         */
+        void nameStyle(std::string_view name, const SgrState &state)
+        {
+            const std::uint64_t key = detail::exportKey(state);
+            if (key == default_key) return;
+            Style &style = styles[key];
+            if (!style.name.empty()) return;
+            style.name = "ts-";
+            for (char c : name)
+            {
+                const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+                style.name += keep ? c : '-';
+            }
+        }
+
+        /**
+         * @brief Names the classes of the text, prefix and suffix of a preset as it is printed with the current
+         * color support: `ts-<name>`, `ts-<name>-prefix` and `ts-<name>-suffix`.
+         *
+         * @param preset The preset.
+         * @param name The name the classes are derived from.
+         */
+        void namePreset(PresetHandle preset, std::string_view name)
+        {
+            const CompiledPreset &compiled = getCompiledPreset(preset);
+            SgrState prefix, text, suffix;
+            prefix.apply(compiled.prefix_styles);
+            text = prefix;
+            text.apply(compiled.text_styles);
+            suffix = text;
+            suffix.apply(compiled.suffix_styles);
+            nameStyle(name, text);
+            nameStyle(std::string(name) + "-prefix", prefix);
+            nameStyle(std::string(name) + "-suffix", suffix);
+        }
 
-    /**
-     * @brief Struct for storing preset configurations.
-     */
-    struct PresetConfig
-    {
-        /** @see StyleString */
-        StyleString prefix;
-        /** @see StyleString */
-        StyleString suffix;
-        /** @see Config */
-        Config config;
+        /**
+         * @brief Names the classes of a preset after the preset itself.
+         *
+         * @param name The name of the preset.
+         * @throws PresetNotFound If the preset does not exist.
+         */
+        void namePreset(std::string_view name)
+        {
+            namePreset(getPresetHandle(name), name);
+        }
+
+        /**
+         * @brief Converts the next chunk of styled output. Escape sequences may be split between chunks.
+         *
+         * Output is passed on to the target in blocks, so part of it may wait in the exporter until `finish()`.
+         *
+         * @param chunk The bytes to convert.
+         */
+        void feed(std::string_view chunk)
+        {
+            if (!started)
+            {
+                begin();
+            }
+            if (format == ExportFormat::HTML)
+            {
+                decoder.feed(chunk, [this](std::string_view text, const SgrState &state) { html(text, state); });
+            }
+            else
+            {
+                decoder.feed(chunk, [this](std::string_view text, const SgrState &state) { svg(text, state); });
+            }
+        }
+
+        /**
+         * @brief Ends the document, writes what is left of it to the target and flushes the target.
+         *
+         * Output fed afterwards starts a new document, in which every class is declared again.
+         */
+        void finish()
+        {
+            if (!started)
+            {
+                begin();
+            }
+            if (format == ExportFormat::HTML)
+            {
+                if (last_key != default_key) buffer += "</span>";
+                buffer += "</pre>\n</body>\n</html>\n";
+            }
+            else
+            {
+                writePiece();
+                // The size is only known now. CSS sizes the image even though it follows the content.
+                buffer += "<style>svg.termstyle{width:";
+                detail::appendTenths(buffer, columns * detail::export_cell_tenths);
+                buffer += "px;height:";
+                detail::appendTenths(buffer, (line + (column != 0)) * detail::export_line_height * 10);
+                buffer += "px}</style>\n</svg>\n";
+            }
+            target.write(buffer);
+            buffer.clear();
+            target.flush();
+
+            decoder.reset();
+            for (auto &entry : styles)
+            {
+                entry.second.declared = false;
+            }
+            started = false;
+            last_key = default_key;
+            last_style = nullptr;
+            line = column = columns = 0;
+        }
     };
 
-    /** @} */ // end of Construct_group
+    /** @} */ // end of Export_group
 
     /**
-     * @brief A map that stores preset configurations.
-     *
-     * This map is used to store preset configurations for termstyle.
-     * The keys are strings representing the names of the presets,
-     * and the values are instances of the `PresetConfig` class.
-     */
-    std::map<std::string, PresetConfig> presets = {};
+     * @defgroup Async_group Asynchronous Output
+     * Content related to handing styled output to a background thread.
+     * @{
+    */
 
     /**
-     * @brief Enum class for parse modes.
+     * @brief Enum class for what `AsyncLogger` does when its queue is full.
      */
-    enum class ParseMode : int
+    enum class OverflowPolicy : int
     {
-        ALL = 0,
-        PREFIX = 1,
-        SUFFIX = 2
+        /** Wait until the background thread makes room. Nothing is lost. */
+        BLOCK = 0,
+        /** Discard the new record. */
+        DROP = 1,
+        /** Discard the oldest queued record to make room for the new one. */
+        DROP_OLDEST = 2
     };
 
-    /**
-     * Parses a list of colors and returns a string representing the color type.
-     *
-     * @param codelist The list of colors to be parsed.
-     * @return A string representing the color type.
-     */
-    std::string parseColortype(std::vector<Color> codelist) noexcept
+    namespace detail
     {
-        if (codelist.empty()) return "";
-        std::string res = "";
-        for (size_t i = 0; i < codelist.size(); i++)
+        /**
+         * A bounded lock-free queue after Dmitry Vyukov's design. Each cell carries a sequence number that tells
+         * producers and consumers whose turn it is, so pushing and popping are a single CAS on the shared position
+         * plus a release store on the cell. Any thread may pop; `AsyncLogger` uses it with a single consumer and
+         * lets producers pop only to discard the oldest record.
+         *
+         * Values stay in their cells, so their buffers are reused instead of reallocated.
+        */
+        template<typename T>
+        class BoundedQueue
         {
-            switch (codelist[i].type)
+        private:
+            struct alignas(64) Cell
+            {
+                std::atomic<std::size_t> sequence;
+                T value;
+            };
+
+            std::unique_ptr<Cell[]> cells;
+            std::size_t mask;
+            alignas(64) std::atomic<std::size_t> push_pos{0};
+            alignas(64) std::atomic<std::size_t> pop_pos{0};
+
+        public:
+            /**
+             * @param capacity The number of cells, rounded up to a power of two.
+            */
+            explicit BoundedQueue(std::size_t capacity)
             {
-            case ColorType::COL16:
-                res += code2string(codelist[i].col16);
-                break;
-            case ColorType::COL256:
-                res += col256_2string(codelist[i].col256);
-                break;
-            case ColorType::COLRGB:
-                res += colrgb_2string(codelist[i].colrgb);
-                break;
-            default:
-                break;
+                std::size_t size = 2;
+                while (size < capacity)
+                {
+                    size *= 2;
+                }
+                cells = std::make_unique<Cell[]>(size);
+                mask = size - 1;
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
             }
-        }
-        return res;
-    }
+
+            /**
+             * Claims a cell and calls `fill(T&)` on it.
+             * @return False if the queue is full.
+            */
+            template<typename Fill>
+            bool tryPush(Fill &&fill)
+            {
+                std::size_t pos = push_pos.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    Cell &cell = cells[pos & mask];
+                    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                    const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                    if (diff == 0)
+                    {
+                        if (push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            fill(cell.value);
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = push_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /**
+             * Claims the oldest cell and calls `take(T&)` on it.
+             * @return False if the queue is empty.
+            */
+            template<typename Take>
+            bool tryPop(Take &&take)
+            {
+                std::size_t pos = pop_pos.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    Cell &cell = cells[pos & mask];
+                    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                    const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                    if (diff == 0)
+                    {
+                        if (pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            take(cell.value);
+                            cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = pop_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /**
+             * @return Whether the oldest cell holds a value that can be popped.
+            */
+            bool ready() const noexcept
+            {
+                const std::size_t pos = pop_pos.load(std::memory_order_relaxed);
+                return cells[pos & mask].sequence.load(std::memory_order_acquire) == pos + 1;
+            }
+
+            /**
+             * @return The number of cells claimed by producers so far.
+            */
+            std::size_t pushed() const noexcept
+            {
+                return push_pos.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @return The number of cells claimed by consumers so far.
+            */
+            std::size_t popped() const noexcept
+            {
+                return pop_pos.load(std::memory_order_acquire);
+            }
+
+            std::size_t capacity() const noexcept
+            {
+                return mask + 1;
+            }
+        };
+
+        /**
+         * A line queued by `AsyncLogger`: the preset to wrap the text in, or `nullptr` for raw output.
+        */
+        struct AsyncRecord
+        {
+            std::shared_ptr<const CompiledPreset> preset;
+            std::string text;
+        };
+
+        /**
+         * The size at which the background thread of `AsyncLogger` writes out what it has collected.
+        */
+        inline constexpr std::size_t async_batch_size = 1 << 16;
+    } // namespace detail
+
+    class AsyncLogger;
+
+    namespace detail
+    {
+        /**
+         * The loggers alive at exit are flushed by `OnExit` before it writes the restore code.
+        */
+        struct AsyncLoggers
+        {
+            std::mutex mutex;
+            std::vector<AsyncLogger *> active;
+        };
+
+        inline AsyncLoggers async_loggers;
+    } // namespace detail
 
     /**
-     * Parses the given `preset` configuration using the specified `mode`.
+     * @brief Prints styled lines from any thread without waiting for the output.
      *
-     * @param preset The preset configuration to parse.
-     * @param mode The parse mode to use (default: `ParseMode::ALL`).
-     * @return A string representing the parsed configuration.
+     * `print()` copies the text into a lock-free queue and returns; a background thread renders the queued lines
+     * with their compiled presets and passes them to the target in batches of up to 64 KiB. Producers never take
+     * a lock unless the background thread is asleep and has to be woken. Each queue cell keeps its text buffer,
+     * so once every cell has held a line as long as the longest printed one, printing does not allocate.
+     *
+     * Lines are written in the order they were queued. When the queue is full, the `OverflowPolicy` decides
+     * whether `print()` waits or a line is dropped. `flush()` waits until everything queued before it is written,
+     * and the destructor writes everything left. Loggers still alive at exit are flushed before the restore code.
      */
-    std::string parse(const PresetConfig &preset, ParseMode mode = ParseMode::ALL) noexcept
+    class AsyncLogger
     {
-        if (mode == ParseMode::PREFIX)
+    private:
+        OutputTarget *target;
+        OverflowPolicy policy;
+        detail::BoundedQueue<detail::AsyncRecord> queue;
+
+        /**
+         * The number of positions popped when the background thread last finished writing.
+         * Everything before it has been written or dropped.
+        */
+        std::atomic<std::size_t> completed{0};
+        std::atomic<std::size_t> dropped_count{0};
+        std::atomic<int> flush_waiters{0};
+        std::atomic<bool> sleeping{false};
+        std::atomic<bool> stopping{false};
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::thread consumer;
+
+        void wakeConsumer()
         {
-            return code2string(preset.prefix.prestyle16)
-                   + col256_2string(preset.prefix.prestlye256)
-                   + parseColortype(preset.prefix.prestyles)
-                   + preset.prefix.text
-                   + code2string(preset.prefix.poststyle16)
-                   + col256_2string(preset.prefix.poststyle256)
-                   + parseColortype(preset.prefix.poststyles);
+            // Pairs with the fence in run(): either this sees the consumer asleep, or it sees the new record.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wake.notify_one();
+            }
         }
-        if (mode == ParseMode::SUFFIX)
+
+        bool push(const std::shared_ptr<const CompiledPreset> &preset, std::string_view text)
         {
-            return code2string(preset.suffix.prestyle16)
-                   + col256_2string(preset.suffix.prestlye256)
-                   + parseColortype(preset.suffix.prestyles)
-                   + preset.suffix.text
-                   + code2string(preset.suffix.poststyle16)
-                   + col256_2string(preset.suffix.poststyle256)
-                   + parseColortype(preset.suffix.poststyles)
-                   + (preset.config.trailing_newline ? "\n" : "");
+            bool failed = false;
+            auto fill = [&](detail::AsyncRecord &record) {
+                // Cells keep their preset, so lines printed with the same presets do not touch the reference count.
+                if (record.preset != preset)
+                {
+                    record.preset = preset;
+                }
+                try
+                {
+                    record.text.assign(text.data(), text.size());
+                }
+                catch (...)
+                {
+                    // The cell is claimed and has to be published, so it is published empty.
+                    record.preset = nullptr;
+                    record.text.clear();
+                    failed = true;
+                }
+            };
+            while (!queue.tryPush(fill))
+            {
+                if (policy == OverflowPolicy::DROP)
+                {
+                    dropped_count.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (policy == OverflowPolicy::DROP_OLDEST)
+                {
+                    if (queue.tryPop([](detail::AsyncRecord &record) { record.text.clear(); }))
+                    {
+                        dropped_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    continue;
+                }
+                wakeConsumer();
+                std::this_thread::yield();
+            }
+            wakeConsumer();
+            if (failed)
+            {
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            return !failed;
         }
-        if (mode == ParseMode::ALL)
+
+        void publish(std::size_t position)
         {
-            return code2string(preset.prefix.prestyle16)
-                   + col256_2string(preset.prefix.prestlye256)
-                   + parseColortype(preset.prefix.prestyles)
-                   + preset.prefix.text
-                   + code2string(preset.prefix.poststyle16)
-                   + col256_2string(preset.prefix.poststyle256)
-                   + parseColortype(preset.prefix.poststyles)
+            completed.store(position);
+            if (flush_waiters.load() != 0)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
 
-                   + code2string(preset.suffix.prestyle16)
-                   + col256_2string(preset.suffix.prestlye256)
-                   + parseColortype(preset.suffix.prestyles)
-                   + preset.suffix.text
-                   + code2string(preset.suffix.poststyle16)
-                   + col256_2string(preset.suffix.poststyle256)
-                   + parseColortype(preset.suffix.poststyles)
+        void run()
+        {
+            std::string batch;
+            batch.reserve(detail::async_batch_size);
+            auto render = [&](detail::AsyncRecord &record) {
+                if (record.preset != nullptr)
+                {
+                    batch.append(record.preset->prefix).append(record.text).append(record.preset->suffix);
+                }
+                else
+                {
+                    batch.append(record.text);
+                }
+                record.text.clear();
+            };
+            for (;;)
+            {
+                while (batch.size() < detail::async_batch_size && queue.tryPop(render)) {}
+                if (!batch.empty())
+                {
+                    target->write(batch);
+                    batch.clear();
+                }
+                // Every position popped so far was either written above or dropped by a producer.
+                publish(queue.popped());
+                if (queue.ready()) continue;
+                if (stopping.load(std::memory_order_acquire)) break;
 
-                   + (preset.config.trailing_newline ? "\n" : "");
+                sleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!queue.ready())
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&] { return queue.ready() || stopping.load(std::memory_order_acquire); });
+                }
+                sleeping.store(false, std::memory_order_relaxed);
+            }
+            target->flush();
         }
-        return "";
-    }
 
-    /**
-     * @ingroup Construct_group
-     * @brief Adds a preset with the given name and configuration.
-     *
-     * This function adds a preset with the specified name and configuration to the termstyle library.
-     *
-     * @param name The name of the preset.
-     * @param preset The configuration for the preset.
-     */
-    void addPreset(std::string name, PresetConfig preset)
-    {
-        if (presets.find(name) != presets.end()) // preset already exists
+    public:
+        /**
+         * @brief Constructs an `AsyncLogger` and starts its background thread.
+         *
+         * @param target The target to write to. It must outlive the logger.
+         * @param capacity The number of lines the queue holds, rounded up to a power of two (default: 1024).
+         * @param policy What to do when the queue is full (default: `OverflowPolicy::BLOCK`).
+         */
+        explicit AsyncLogger(OutputTarget &target, std::size_t capacity = 1024, OverflowPolicy policy = OverflowPolicy::BLOCK)
+            : target(&target), policy(policy), queue(capacity)
         {
-            throw PresetNameUsed(name);
+            std::lock_guard<std::mutex> lock(detail::async_loggers.mutex);
+            detail::async_loggers.active.push_back(this);
+            try
+            {
+                consumer = std::thread([this] { run(); });
+            }
+            catch (...)
+            {
+                detail::async_loggers.active.pop_back();
+                throw;
+            }
         }
 
-        if (preset.config.leading_restore)
+        /**
+         * @brief Constructs an `AsyncLogger` that writes to the default target.
+         */
+        explicit AsyncLogger(std::size_t capacity = 1024, OverflowPolicy policy = OverflowPolicy::BLOCK)
+            : AsyncLogger(defaultTarget(), capacity, policy) {}
+
+        AsyncLogger(const AsyncLogger &) = delete;
+        AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+        /**
+         * @brief Writes every queued line, flushes the target and stops the background thread.
+         */
+        ~AsyncLogger()
         {
-            preset.prefix.prestyles.insert(preset.prefix.prestyles.begin(), Color(Codes::RESTORE));
+            {
+                std::lock_guard<std::mutex> lock(detail::async_loggers.mutex);
+                std::vector<AsyncLogger *> &active = detail::async_loggers.active;
+                active.erase(std::remove(active.begin(), active.end(), this), active.end());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping.store(true, std::memory_order_release);
+            }
+            wake.notify_one();
+            consumer.join();
         }
-        if (preset.config.trailing_restore)
+
+        /**
+         * Queues the specified text styled with the preset referred to by `preset`.
+         *
+         * @param preset The handle of the preset style to apply to the text.
+         * @param text   The text to be printed.
+         * @return False if the line was dropped.
+         */
+        bool print(PresetHandle preset, std::string_view text = "")
         {
-            preset.suffix.poststyles.emplace_back(Color(Codes::RESTORE));
+            return push(detail::sharedPreset(preset, target->colorSupport()), text);
         }
 
-        presets[name] = std::move(preset);
-    }
+        /**
+         * Queues the specified text styled with the given preset.
+         *
+         * @param preset The name of the preset style to apply to the text.
+         * @param text   The text to be printed.
+         * @return False if the line was dropped.
+         */
+        bool print(std::string_view preset, std::string_view text = "")
+        {
+            return print(getPresetHandle(preset), text);
+        }
 
-    /**
-     * @defgroup PresetUse_group Using Presets
-     * Content related to using presets.
-     * @{
-    */
+        /**
+         * Formats the arguments on the calling thread and queues them styled with the preset referred to by `preset`.
+         *
+         * @param preset The handle of the preset style to apply to the text.
+         * @param fmt    The format string, e.g. `"x={} y={}"`.
+         * @param args   The arguments to format.
+         * @return False if the line was dropped.
+         */
+        template<typename Arg, typename... Args>
+        bool print(PresetHandle preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
+        {
+            const ColorSupport support = target->colorSupport();
+            const std::shared_ptr<const CompiledPreset> &compiled = detail::sharedPreset(preset, support);
+            const detail::FormatScope scope(support, compiled->text_state);
+            std::string &text = detail::lineBuffer();
+            detail::formatTo<Arg, Args...>(text, fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
+            return push(compiled, text);
+        }
 
-    
-    /**
-     * Prints the specified text using the given preset style.
-     *
-     * @param preset The preset style to apply to the text.
-     * @param text   The text to be printed. If not provided, an empty string will be printed.
-     */
-    void print(std::string preset, std::string text = "")
-    {
-        if (presets.find(preset) == presets.end())
+        /**
+         * Formats the arguments on the calling thread and queues them styled with the given preset.
+         *
+         * @param preset The name of the preset style to apply to the text.
+         * @param fmt    The format string, e.g. `"x={} y={}"`.
+         * @param args   The arguments to format.
+         * @return False if the line was dropped.
+         */
+        template<typename Arg, typename... Args>
+        bool print(std::string_view preset, FormatString<Arg, Args...> fmt, Arg &&arg, Args &&...args)
         {
-            throw PresetNotFound(preset);
+            return print<Arg, Args...>(getPresetHandle(preset), fmt, std::forward<Arg>(arg), std::forward<Args>(args)...);
         }
-        const PresetConfig &config = presets[preset];
-        std::cout << parse(config, ParseMode::PREFIX) << text << parse(config, ParseMode::SUFFIX);
-    }
 
-    /**
-     * @brief A class that provides styled output to the standard output stream.
-     * 
-     * The `StyledCout` class allows you to output text with custom styles to the standard output stream (`std::cout`).
-     * It takes a `PresetConfig` object as a parameter, which contains the configuration for the styles to be applied.
-     * The styles are applied to the text when it is printed to the standard output stream.
-     */
-    class StyledCout
-    {
-    private:
         /**
-         * The configuration for the preset style.
-         * 
-         * @see PresetConfig
-        */
-        const PresetConfig &config;
+         * Queues raw bytes, e.g. a rendered `StyledText`, to be written as they are.
+         *
+         * @param data The bytes to write.
+         * @return False if the bytes were dropped.
+         */
+        bool write(std::string_view data)
+        {
+            return push(nullptr, data);
+        }
 
-    public:
-        explicit StyledCout(const PresetConfig &config) : config(config)
+        /**
+         * @brief Waits until everything queued before the call is written, then flushes the target.
+         */
+        void flush()
         {
-            std::cout << parse(config, ParseMode::PREFIX);
+            const std::size_t position = queue.pushed();
+            flush_waiters.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [&] { return completed.load() >= position; });
+            }
+            flush_waiters.fetch_sub(1);
+            target->flush();
         }
 
-        ~StyledCout()
+        /**
+         * @return The number of lines dropped because the queue was full.
+        */
+        std::size_t dropped() const noexcept
         {
-            std::cout << parse(config, ParseMode::SUFFIX);
+            return dropped_count.load(std::memory_order_relaxed);
         }
 
-        template<typename T>
-        std::ostream& operator<<(const T& value)
+        /**
+         * @return The number of lines the queue holds.
+        */
+        std::size_t capacity() const noexcept
         {
-            return std::cout << value;
+            return queue.capacity();
         }
     };
 
-    /**
-     * Applies a specific style preset to the output stream.
-     *
-     * @param preset The name of the style preset to apply.
-     * @return A `StyledCout` object that can be used to chain additional styling or output operations.
-     */
-    StyledCout style(const std::string &preset)
+    namespace detail
     {
-        if (presets.find(preset) == presets.end())
+        inline void flushAsyncLoggers()
         {
-            throw PresetNotFound(preset);
+            std::lock_guard<std::mutex> lock(async_loggers.mutex);
+            for (AsyncLogger *logger : async_loggers.active)
+            {
+                logger->flush();
+            }
         }
-        return StyledCout(presets[preset]);
-    }
+    } // namespace detail
 
-    /** @} */
+    /** @} */ // end of Async_group
 
     /**
      * @brief The `OnExit` class is a helper class that performs an action when it goes out of scope.
@@ -733,7 +7439,8 @@ namespace termstyle
      * when it goes out of scope, regardless of how the scope is exited (e.g., normal exit, exception, etc.).
      * 
      * In this specific implementation, the `OnExit` class is used to restore the terminal style by printing
-     * the restore code when the object goes out of scope.
+     * the restore code to the default target when the object goes out of scope.
+     * Every `AsyncLogger` still alive is flushed first, so its queued lines are written before the restore code.
      */
     class OnExit
     {
@@ -746,12 +7453,48 @@ namespace termstyle
          */
         ~OnExit()
         {
-            std::cout << code2string<Codes>({Codes::RESTORE});
+            detail::flushAsyncLoggers();
+            OutputTarget &target = defaultTarget();
+            if (target.colorSupport() != ColorSupport::NONE)
+            {
+                target.write(static_style<Codes::RESTORE>.view());
+            }
+            target.flush();
         }
     };
 
-    OnExit onExitInstance;
+    inline OnExit onExitInstance;
 
 } // namespace termstyle
 
+#if defined(__cpp_lib_format)
+namespace std
+{
+    /**
+     * @ingroup Format_group
+     * @brief Formats a `termstyle::styled()` value with its escape sequence, e.g.
+     * `std::format("{:>8}", termstyle::styled(elapsed, termstyle::bold))`. The format specification applies to the value.
+     */
+    template<typename T, typename... Styles>
+    struct formatter<termstyle::Styled<T, Styles...>, char> : formatter<termstyle::detail::FormatValue<T>, char>
+    {
+        template<typename FormatContext>
+        auto format(const termstyle::Styled<T, Styles...> &value, FormatContext &ctx) const
+        {
+            const termstyle::detail::FormatContext &context = termstyle::detail::formatContext();
+            const termstyle::ColorSupport support = context.colorSupport();
+            char prefix[3 + termstyle::detail::max_param_length * sizeof...(Styles)];
+            const std::size_t length = termstyle::detail::renderExpr(prefix, value.style, support);
+            ctx.advance_to(std::copy(prefix, prefix + length, ctx.out()));
+            termstyle::detail::IteratorSink<decltype(ctx.out())> sink{formatter<termstyle::detail::FormatValue<T>, char>::format(value.value, ctx)};
+            if (length != 0)
+            {
+                termstyle::detail::renderStyledEnd(sink, value.style, support, context.around);
+            }
+            return sink.out;
+        }
+    };
+} // namespace std
+#endif
+
 #endif // TERMSTYLE_HPP
@@ -0,0 +1,174 @@
+/**
+ * async.cpp -- tests the asynchronous logger: ordering across threads, the overflow policies and flushing
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * A target whose writes wait until it is opened, so the queue of a logger writing to it fills up.
+*/
+class GatedTarget : public ts::OutputTarget
+{
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool open = false;
+    bool waiting = false;
+
+public:
+    std::string output;
+
+    void write(std::string_view data) override
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting = true;
+        changed.notify_all();
+        changed.wait(lock, [&] { return open; });
+        output.append(data);
+    }
+
+    void waitForWriter()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return waiting; });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        changed.notify_all();
+    }
+};
+
+/**
+ * Fills a logger writing to a gated target with 100 lines while its background thread is stuck on the first.
+ * @return The output.
+*/
+std::string overflow(ts::OverflowPolicy policy, std::size_t &dropped)
+{
+    GatedTarget target;
+    ts::AsyncLogger logger(target, 8, policy);
+    logger.write("0\n");
+    target.waitForWriter();
+    // A blocking logger waits for room, so the target has to be opened while it is being filled.
+    std::thread opener;
+    if (policy == ts::OverflowPolicy::BLOCK)
+    {
+        opener = std::thread([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            target.release();
+        });
+    }
+    for (int i = 1; i < 100; i++)
+    {
+        logger.write(std::to_string(i) + "\n");
+    }
+    dropped = logger.dropped();
+    if (opener.joinable())
+    {
+        opener.join();
+    }
+    target.release();
+    logger.flush();
+    return target.output;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::PresetHandle worker = ts::addPreset("worker", {
+        .prefix = {
+            .prestyles = {ts::Color(ts::Codes::DIM)}
+        }
+    });
+    const std::string &prefix = ts::getCompiledPreset(worker).prefix;
+    const std::string &suffix = ts::getCompiledPreset(worker).suffix;
+
+    int failures = 0;
+    const int thread_count = 4;
+    const int lines_per_thread = 5000;
+    ts::RingBufferTarget target(1 << 22);
+    {
+        ts::AsyncLogger logger(target, 64);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < thread_count; t++)
+        {
+            producers.emplace_back([&, t] {
+                for (int i = 0; i < lines_per_thread; i++)
+                {
+                    logger.print(worker, "{} {}", t, i);
+                }
+            });
+        }
+        for (std::thread &producer : producers)
+        {
+            producer.join();
+        }
+        logger.flush();
+        if (logger.dropped() != 0)
+        {
+            std::cerr << "Lines were dropped while blocking.\n";
+            failures++;
+        }
+    }
+
+    // Every line must be intact, and the lines of each thread in order.
+    const std::string output = target.contents();
+    std::vector<int> next(thread_count, 0);
+    int lines = 0;
+    for (std::size_t pos = 0; pos < output.size(); lines++)
+    {
+        const std::size_t end = output.find(suffix, pos);
+        if (output.compare(pos, prefix.size(), prefix) != 0 || end == std::string::npos)
+        {
+            break;
+        }
+        const std::string text = output.substr(pos + prefix.size(), end - pos - prefix.size());
+        const int t = std::stoi(text);
+        if (text != std::to_string(t) + " " + std::to_string(next[t]))
+        {
+            break;
+        }
+        next[t]++;
+        pos = end + suffix.size();
+    }
+    if (lines != thread_count * lines_per_thread)
+    {
+        std::cerr << "Only " << lines << " lines were written intact and in order.\n";
+        failures++;
+    }
+
+    std::size_t dropped = 0;
+    std::string kept = overflow(ts::OverflowPolicy::DROP, dropped);
+    if (kept != "0\n1\n2\n3\n4\n5\n6\n7\n8\n" || dropped != 91)
+    {
+        std::cerr << "Unexpected output when dropping new lines.\n";
+        failures++;
+    }
+    kept = overflow(ts::OverflowPolicy::DROP_OLDEST, dropped);
+    if (kept != "0\n92\n93\n94\n95\n96\n97\n98\n99\n" || dropped != 91)
+    {
+        std::cerr << "Unexpected output when dropping old lines.\n";
+        failures++;
+    }
+    kept = overflow(ts::OverflowPolicy::BLOCK, dropped);
+    if (kept.size() != 290 || dropped != 0)
+    {
+        std::cerr << "Unexpected output when blocking.\n";
+        failures++;
+    }
+
+    // Never destroyed: its line is written when OnExit flushes it, before the restore code.
+    ts::AsyncLogger *at_exit = new ts::AsyncLogger();
+    at_exit->print(worker, "written at exit");
+    return failures == 0 ? 0 : 1;
+}
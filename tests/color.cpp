@@ -0,0 +1,81 @@
+/**
+ * color.cpp -- tests the packed Color representation and the inline storage of style lists
+*/
+
+#include <string>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    static_assert(sizeof(ts::Color) == 4, "Color is packed into 4 bytes");
+    static_assert(std::is_trivially_copyable_v<ts::Color> && std::is_trivially_copyable_v<ts::SgrState>);
+
+    int failures = 0;
+    constexpr ts::Color red(ts::Codes::FOREGROUND_RED);
+    constexpr ts::Color orange(ts::Col256(ts::ColorMode::FOREGROUND, 208));
+    constexpr ts::Color sky(ts::ColRGB(ts::ColorMode::BACKGROUND, 30, 144, 255));
+    static_assert(red.type() == ts::ColorType::COL16 && red.col16() == ts::Codes::FOREGROUND_RED);
+    static_assert(orange.type() == ts::ColorType::COL256 && orange.col256().ID == 208);
+    static_assert(sky.type() == ts::ColorType::COLRGB && sky.mode() == ts::ColorMode::BACKGROUND);
+    static_assert(sky.colrgb().r == 30 && sky.colrgb().g == 144 && sky.colrgb().b == 255);
+    static_assert(red != orange && orange == ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 208)));
+
+    const ts::ColRGB clamped = ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, -5, 128, 300)).colrgb();
+    if (clamped.r != 0 || clamped.g != 128 || clamped.b != 255)
+    {
+        std::cerr << "RGB components were not clamped.\n";
+        failures++;
+    }
+
+    // Six colors do not fit inline, so the list moves to the heap and must render like a vector.
+    const std::vector<ts::Color> colors = {red, orange, sky, ts::Color(ts::Codes::BRIGHT),
+                                           ts::Color(ts::Codes::UNDERLINE), ts::Color(ts::Codes::ITALIC)};
+    ts::StyleList<ts::Color> list;
+    for (ts::Color col : colors)
+    {
+        list.push_back(col);
+    }
+    ts::StyleList<ts::Color> copy = list;
+    list.insert(list.begin(), ts::Color(ts::Codes::RESTORE));
+    list.erase(list.begin());
+    if (copy.size() != colors.size() || ts::parseColortype(copy) != ts::parseColortype(colors)
+        || ts::parseColortype(list) != ts::parseColortype(colors))
+    {
+        std::cerr << "Style lists do not match the vector they were built from.\n";
+        failures++;
+    }
+
+    ts::StyleList<ts::Color> moved = std::move(copy);
+    ts::StyleList<ts::Codes> codes = {ts::Codes::BRIGHT, ts::Codes::FOREGROUND_GREEN};
+    std::string rendered;
+    ts::append_to(rendered, codes);
+    if (moved.size() != colors.size() || !copy.empty() || rendered != "\033[1;32m")
+    {
+        std::cerr << "Unexpected contents after moving or rendering a list.\n";
+        failures++;
+    }
+
+    ts::PresetConfig preset = {
+        .prefix = {
+            .text = "[COLORS] ",
+            .prestyles = {red, orange, sky, ts::Color(ts::Codes::BRIGHT)},
+        }
+    };
+    ts::PresetConfig preset_copy = preset;
+    preset.prefix.prestyles.clear();
+    ts::addPreset("colors", preset_copy);
+    if (ts::parse(ts::presets["colors"], ts::ParseMode::PREFIX)
+        != "\033[0m\033[31m\033[38;5;208m\033[48;2;30;144;255m\033[1m[COLORS] ")
+    {
+        std::cerr << "Unexpected prefix of a preset with a spilled style list.\n";
+        failures++;
+    }
+
+    ts::print("colors", "Five colors, one of them added by addPreset().");
+    return failures == 0 ? 0 : 1;
+}
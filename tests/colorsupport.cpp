@@ -0,0 +1,157 @@
+/**
+ * colorsupport.cpp -- tests that each output target detects its own color support, with standard output on a terminal
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "../include/termstyle.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ts = termstyle;
+
+#if defined(_WIN32)
+int main()
+{
+    std::cout << "skipped: needs a pseudo-terminal\n";
+    return 0;
+}
+#else
+namespace
+{
+    /**
+     * Reads what has been written to the terminal so far.
+    */
+    std::string drain(int master)
+    {
+        std::string data;
+        char buf[4096];
+        for (ssize_t n; (n = read(master, buf, sizeof(buf))) > 0;) data.append(buf, static_cast<std::size_t>(n));
+        return data;
+    }
+
+    std::string readFile(std::FILE *file)
+    {
+        std::fflush(file);
+        std::rewind(file);
+        std::string data;
+        char buf[4096];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) > 0;) data.append(buf, n);
+        return data;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+    unsetenv("NO_COLOR");
+    unsetenv("FORCE_COLOR");
+    unsetenv("COLORTERM");
+    setenv("TERM", "xterm-256color", 1);
+
+    // Standard output becomes a terminal before anything detects the color support.
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        std::cout << "skipped: no pseudo-terminal available\n";
+        return 0;
+    }
+    const int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    const int saved_stdout = dup(1);
+    if (slave < 0 || saved_stdout < 0 || dup2(slave, 1) < 0)
+    {
+        std::cout << "skipped: cannot redirect standard output\n";
+        return 0;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    const ts::PresetHandle warn = ts::addPreset("warn", {
+        .prefix = {
+            .text = "[WARN] ",
+            .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 214))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+    ts::StyledText text;
+    text.append("styled", {ts::Color(ts::Codes::FOREGROUND_RED)});
+
+    // The terminal gets colors.
+    ts::print(warn, "to the terminal");
+    ts::print(text);
+    std::cout << ts::styled("inserted", ts::bold) << "\n";
+    std::cout.flush();
+    const std::string shown = drain(master);
+    if (ts::defaultTarget().colorSupport() != ts::ColorSupport::COL256 || shown.find("\033[38;5;214m[WARN] ") == std::string::npos
+        || shown.find("\033[31mstyled") == std::string::npos || shown.find("\033[1minserted\033[0m") == std::string::npos)
+    {
+        std::cerr << "Standard output on a terminal printed " << shown.size() << " bytes without the expected colors.\n";
+        failures++;
+    }
+
+    // A file does not, even though standard output is a terminal.
+    std::FILE *file = std::tmpfile();
+    ts::FileTarget file_target(file);
+    ts::print(file_target, warn, "to a file");
+    ts::print(file_target, text);
+    {
+        ts::StyledWriter writer(file_target);
+        writer.print(warn, "through a writer");
+        writer.print(text);
+    }
+    ts::print(file_target, warn, "{} argument", ts::styled("styled", ts::bold));
+    ts::style(warn, file_target) << "through style()";
+    ts::StyledCout(ts::presets.at("warn"), file_target) << "through a config";
+    const std::string written = readFile(file);
+    if (file_target.colorSupport() != ts::ColorSupport::NONE
+        || written != "[WARN] to a file\nstyled[WARN] through a writer\nstyled[WARN] styled argument\n[WARN] through style()\n[WARN] through a config\n")
+    {
+        std::cerr << "A file target wrote \"" << written << "\".\n";
+        failures++;
+    }
+
+    // Nor does a stream other than standard output and error.
+    std::ostringstream stream;
+    stream << ts::styled("inserted", ts::bold);
+    if (stream.str() != "inserted" || ts::StreamTarget(stream).colorSupport() != ts::ColorSupport::NONE)
+    {
+        std::cerr << "A string stream got \"" << stream.str() << "\".\n";
+        failures++;
+    }
+
+    // Nor does a file descriptor of a file.
+    std::FILE *fd_file = std::tmpfile();
+    ts::FdTarget fd_target(fileno(fd_file));
+    ts::print(fd_target, warn, "to a descriptor");
+    if (fd_target.colorSupport() != ts::ColorSupport::NONE || readFile(fd_file) != "[WARN] to a descriptor\n")
+    {
+        std::cerr << "A file descriptor target wrote colors.\n";
+        failures++;
+    }
+
+    // A target can be told its color support, whatever it is attached to.
+    std::FILE *forced_file = std::tmpfile();
+    ts::FileTarget forced(forced_file);
+    forced.setColorSupport(ts::ColorSupport::COL16);
+    ts::print(forced, warn, "forced");
+    const std::string downgraded = readFile(forced_file);
+    if (forced.colorSupport() != ts::ColorSupport::COL16 || downgraded.find("\033[33m[WARN] ") == std::string::npos
+        || downgraded.find("38;5") != std::string::npos)
+    {
+        std::cerr << "A target forced to 16 colors wrote \"" << downgraded << "\".\n";
+        failures++;
+    }
+
+    std::fclose(file);
+    std::fclose(fd_file);
+    std::fclose(forced_file);
+    const std::string summary = "terminal got " + std::to_string(shown.size()) + " bytes, files got no escapes\n";
+    ssize_t ignored = write(saved_stdout, summary.data(), summary.size());
+    (void)ignored;
+    return failures == 0 ? 0 : 1;
+}
+#endif
@@ -0,0 +1,168 @@
+/**
+ * decode.cpp -- tests decoding styled output back into states, whole, in chunks and from random bytes
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+using Runs = std::vector<std::pair<std::string, ts::SgrState>>;
+
+std::size_t empty_runs = 0;
+
+/**
+ * Decodes `input` in chunks of the given sizes (cycled), joining adjacent runs in the same state.
+*/
+Runs decode(const std::string &input, const std::vector<std::size_t> &chunks, ts::SgrState *end = nullptr)
+{
+    Runs runs;
+    ts::SgrDecoder decoder;
+    auto on_text = [&runs](std::string_view text, const ts::SgrState &state) {
+        empty_runs += text.empty();
+        if (!runs.empty() && runs.back().second == state)
+        {
+            runs.back().first.append(text.data(), text.size());
+        }
+        else
+        {
+            runs.emplace_back(std::string(text), state);
+        }
+    };
+    for (std::size_t pos = 0, i = 0; pos < input.size(); i++)
+    {
+        const std::size_t size = std::min(chunks[i % chunks.size()], input.size() - pos);
+        decoder.feed(std::string_view(input).substr(pos, size), on_text);
+        pos += size;
+    }
+    if (end) *end = decoder.state();
+    return runs;
+}
+
+int main()
+{
+    int failures = 0;
+    std::mt19937 rng(11);
+
+    // Every color rendered by parseColortype() decodes to the state it was applied to.
+    std::vector<ts::Color> colors;
+    for (int code : {0, 1, 2, 3, 4, 5, 7, 8, 9, 22, 23, 24, 25, 27, 28, 29, 30, 31, 36, 37, 39, 40, 44, 47, 49})
+    {
+        colors.emplace_back(static_cast<ts::Codes>(code));
+    }
+    for (int id = 0; id < 256; id++)
+    {
+        colors.emplace_back(ts::Col256(id % 2 ? ts::ColorMode::FOREGROUND : ts::ColorMode::BACKGROUND, id));
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        colors.emplace_back(ts::ColRGB(i % 2 ? ts::ColorMode::FOREGROUND : ts::ColorMode::BACKGROUND,
+                                       static_cast<int>(rng() % 256), static_cast<int>(rng() % 256), i));
+    }
+    for (int round = 0; round < 500; round++)
+    {
+        std::vector<ts::Color> list;
+        for (std::size_t n = 1 + rng() % 4; n > 0; n--) list.push_back(colors[rng() % colors.size()]);
+        ts::SgrState expected;
+        expected.apply(list);
+        ts::SgrState decoded;
+        const Runs runs = decode(ts::parseColortype(list) + "x", {1 + rng() % 8}, &decoded);
+        if (runs.size() != 1 || runs[0].first != "x" || runs[0].second != expected || decoded != expected)
+        {
+            std::cerr << "Colors of round " << round << " do not decode to their state.\n";
+            failures++;
+            break;
+        }
+    }
+
+    // Styled text decodes back into its spans.
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::StyledText status;
+    status.append(" NORMAL ", {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::REVERSE)})
+        .append(" main.cpp ", {ts::Color(ts::Col256(ts::ColorMode::BACKGROUND, 236))})
+        .append("[+]", {ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 200, 80))})
+        .append(" | ");
+    std::string rendered;
+    ts::append_to(rendered, status);
+    const Runs runs = decode(rendered, {rendered.size()});
+    ts::SgrState end;
+    decode(rendered, {3}, &end);
+    bool spans_match = runs.size() == status.spans().size() && end == ts::SgrState();
+    for (std::size_t i = 0; spans_match && i < runs.size(); i++)
+    {
+        const ts::StyledText::Span &span = status.spans()[i];
+        spans_match = runs[i].first == status.text().substr(span.offset, span.length) && runs[i].second == span.style;
+    }
+    if (!spans_match)
+    {
+        std::cerr << "Styled text does not decode into its spans.\n";
+        failures++;
+    }
+
+    // Other sequences have no effect, and a lone ESC is text.
+    const Runs others = decode("\033[2J\033[?25l\033[31ma\033[1;2Hb\033x\033", {1});
+    ts::SgrState red;
+    red.apply(ts::Codes::FOREGROUND_RED);
+    if (others.size() != 1 || others[0].first != "ab\033x" || others[0].second != red)
+    {
+        std::cerr << "Unexpected decoding of other sequences.\n";
+        failures++;
+    }
+
+    // Colon subparameters form one parameter, with or without the color space ID, and unknown ones are ignored.
+    ts::SgrState bold_red;
+    bold_red.apply(ts::Codes::BRIGHT);
+    bold_red.apply(ts::ColRGB(ts::ColorMode::FOREGROUND, 255, 0, 0));
+    ts::SgrState bold_blue_on_196 = bold_red;
+    bold_blue_on_196.apply(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 0, 255));
+    bold_blue_on_196.apply(ts::Col256(ts::ColorMode::BACKGROUND, 196));
+    const Runs itu = decode("\033[1;38:2::255:0:0mX\033[38:2:0:0:255;48:5:196mY\033[4:3;58:2::1:2:3;1:2:3:4:5:6:7mZ", {1, 3});
+    if (itu != Runs{{"X", bold_red}, {"YZ", bold_blue_on_196}} || decode("\033[1;38;2;255;0;0mX", {2}) != Runs{{"X", bold_red}})
+    {
+        std::cerr << "Unexpected decoding of colon subparameters.\n";
+        failures++;
+    }
+
+    // Random bytes, rich in escape sequences, decode the same however they are split,
+    // and rendering the decoded runs again decodes to the same runs.
+    const std::string pieces[] = {"\033", "[", "m", ";", "38", "48", "5", "2", "1", "255", "0", ":", "x", "é", "?", "J", "\n"};
+    for (int round = 0; round < 5000; round++)
+    {
+        std::string input;
+        for (std::size_t n = rng() % 60; n > 0; n--) input += pieces[rng() % std::size(pieces)];
+        const Runs whole = decode(input, {input.size() + 1});
+        const Runs split = decode(input, {1 + rng() % 5, 1 + rng() % 3});
+        std::string again;
+        ts::SgrState state;
+        for (const auto &run : whole)
+        {
+            again += ts::transition(state, run.second) + run.first;
+            state = run.second;
+        }
+        if (whole != split)
+        {
+            std::cerr << "Random input of round " << round << " decodes differently in chunks.\n";
+            failures++;
+            break;
+        }
+        bool text_has_escape = false;
+        for (const auto &run : whole) text_has_escape = text_has_escape || run.first.find('\033') != std::string::npos;
+        if (!text_has_escape && decode(again, {7}) != whole)
+        {
+            std::cerr << "Random input of round " << round << " does not survive rendering again.\n";
+            failures++;
+            break;
+        }
+    }
+
+    if (empty_runs != 0)
+    {
+        std::cerr << empty_runs << " empty runs of text.\n";
+        failures++;
+    }
+
+    std::cout << "decoded " << runs.size() << " spans of styled text\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/**
+ * export.cpp -- tests converting styled output into HTML and SVG, in chunks and with bounded buffering
+*/
+
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * Keeps everything written to it, and the size of the largest write.
+*/
+struct StringTarget : ts::OutputTarget
+{
+    std::string data;
+    std::size_t largest = 0;
+
+    void write(std::string_view bytes) override
+    {
+        data.append(bytes.data(), bytes.size());
+        largest = std::max(largest, bytes.size());
+    }
+};
+
+std::string convert(const std::string &input, ts::ExportFormat format, std::size_t chunk)
+{
+    StringTarget target;
+    ts::Exporter exporter(target, format);
+    for (std::size_t pos = 0; pos < input.size(); pos += chunk)
+    {
+        exporter.feed(std::string_view(input).substr(pos, chunk));
+    }
+    exporter.finish();
+    return target.data;
+}
+
+std::size_t count(const std::string &str, const std::string &needle)
+{
+    std::size_t n = 0;
+    for (std::size_t pos = str.find(needle); pos != std::string::npos; pos = str.find(needle, pos + 1)) n++;
+    return n;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    int failures = 0;
+
+    // Each style is declared once, text is escaped, and the palette and RGB colors map to CSS colors.
+    ts::StyledText status;
+    for (int i = 0; i < 3; i++)
+    {
+        status.append("<a & b>", {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_RED)})
+            .append(" x ", {ts::Color(ts::Col256(ts::ColorMode::BACKGROUND, 196))})
+            .append("y\n", {ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 200, 80)), ts::Color(ts::Codes::UNDERLINE)})
+            .append("plain\n");
+    }
+    std::string rendered;
+    ts::append_to(rendered, status);
+    const std::string html = convert(rendered, ts::ExportFormat::HTML, rendered.size());
+    const std::string expected_rules[] = {
+        "<style>.ts1{color:#cd0000;font-weight:bold;}</style>",
+        "<style>.ts2{background-color:#ff0000;}</style>",
+        "<style>.ts3{color:#00c850;text-decoration:underline;}</style>",
+    };
+    bool rules_match = count(html, "<style>.") == std::size(expected_rules);
+    for (const std::string &rule : expected_rules) rules_match = rules_match && count(html, rule) == 1;
+    if (!rules_match || count(html, "<span class=\"ts1\">&lt;a &amp; b&gt;</span>") != 3
+        || html.find("</span>plain\n<span") == std::string::npos || html.rfind("</pre>\n</body>\n</html>\n") + 23 != html.size())
+    {
+        std::cerr << "Unexpected HTML document of " << html.size() << " bytes.\n";
+        failures++;
+    }
+
+    // Any split of the input converts to the same document.
+    for (std::size_t chunk : {1, 2, 7})
+    {
+        if (convert(rendered, ts::ExportFormat::HTML, chunk) != html
+            || convert(rendered, ts::ExportFormat::SVG, chunk) != convert(rendered, ts::ExportFormat::SVG, rendered.size()))
+        {
+            std::cerr << "Converting in chunks of " << chunk << " differs.\n";
+            failures++;
+        }
+    }
+
+    // Colors with colon subparameters keep the other attributes of their sequence.
+    if (count(convert("\033[1;38:2::255:0:0mX\033[0m", ts::ExportFormat::HTML, 5), "<style>.ts1{color:#ff0000;font-weight:bold;}</style>") != 1)
+    {
+        std::cerr << "A color with colon subparameters is not exported with its attributes.\n";
+        failures++;
+    }
+
+    // Presets give their classes readable names.
+    ts::addPreset("warn", {
+        .prefix = {
+            .text = "[WARN] ",
+            .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 214))},
+            .poststyles = {ts::Color(ts::Codes::RESTORE), ts::Color(ts::Codes::ITALIC)}
+        }
+    });
+    ts::RingBufferTarget log(1 << 16);
+    {
+        ts::StyledWriter writer(log);
+        writer.print("warn", "disk almost full");
+        writer.print("warn", "disk full");
+    }
+    StringTarget named;
+    {
+        ts::Exporter exporter(named);
+        exporter.namePreset("warn");
+        exporter.feed(log.contents());
+    }
+    if (count(named.data, "<style>.ts-warn-prefix{color:#ffaf00;}</style>") != 1
+        || count(named.data, "<style>.ts-warn{font-style:italic;}</style>") != 1
+        || count(named.data, "<span class=\"ts-warn-prefix\">[WARN] </span><span class=\"ts-warn\">disk full") != 1)
+    {
+        std::cerr << "Unexpected classes of a named preset.\n";
+        failures++;
+    }
+
+    // Text is laid out on the SVG grid, with tab stops and backgrounds.
+    ts::SgrState reversed;
+    reversed.apply(ts::Codes::REVERSE);
+    const std::string svg = convert("ab\tc\n" + ts::transition(ts::SgrState(), reversed) + " é \033[0m", ts::ExportFormat::SVG, 3);
+    const std::string expected_svg[] = {
+        "<text x=\"0\" y=\"13\">ab</text>\n<text x=\"67.2\" y=\"13\">c</text>\n",
+        "<style>.ts1{fill:#000000;}.ts1-bg{fill:#e5e5e5}</style><rect class=\"ts1-bg\" x=\"0\" y=\"17\" width=\"25.2\" height=\"17\"/>\n"
+        "<text class=\"ts1\" x=\"0\" y=\"30\"> é </text>\n",
+        "<style>svg.termstyle{width:75.6px;height:34px}</style>\n</svg>\n",
+    };
+    for (const std::string &part : expected_svg)
+    {
+        if (count(svg, part) != 1)
+        {
+            std::cerr << "The SVG document lacks " << part.size() << " expected bytes.\n";
+            failures++;
+        }
+    }
+
+    // Large input is written in blocks: the exporter buffers a bounded amount however it is fed.
+    std::string large;
+    while (large.size() < (8u << 20)) large += rendered;
+    StringTarget blocks;
+    {
+        ts::Exporter exporter(blocks);
+        exporter.feed(large);
+    }
+    if (blocks.largest > (1u << 17) || count(blocks.data, "<style>.") != 3)
+    {
+        std::cerr << "A write of " << blocks.largest << " bytes while converting large input.\n";
+        failures++;
+    }
+
+    std::cout << "exported " << html.size() << " bytes of HTML and " << svg.size() << " bytes of SVG\n";
+    return failures == 0 ? 0 : 1;
+}
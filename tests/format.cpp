@@ -0,0 +1,84 @@
+/**
+ * format.cpp -- tests printing formatted arguments with a preset
+*/
+
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    ts::PresetHandle stats = ts::addPreset("stats", {
+        .prefix = {
+            .text = "[STATS] ",
+            .prestyles = {ts::Color(ts::Codes::FOREGROUND_CYAN)},
+            .poststyles = {ts::Color(ts::Codes::FOREGROUND_RESET)}
+        }
+    });
+
+    int failures = 0;
+    ts::RingBufferTarget target(4096);
+    const std::string name = "cache";
+    ts::print(target, stats, "{} hit {} of {} requests ({}%) {{ok}}", name, 930u, 1000L, 93.5);
+    ts::print(target, "stats", "{} {}", ts::styled("slow", ts::bold | ts::fg(ts::Codes::FOREGROUND_RED)), true);
+    const std::string expected = "\033[0m\033[36m[STATS] \033[39mcache hit 930 of 1000 requests (93.5%) {ok}\033[0m\n"
+                                 "\033[0m\033[36m[STATS] \033[39m\033[1;31mslow\033[0m true\033[0m\n";
+    if (target.contents() != expected)
+    {
+        std::cerr << "Unexpected formatted output of " << target.contents().size() << " bytes.\n";
+        failures++;
+    }
+
+    std::string line;
+    ts::append_format(line, "{}-{}-{}", 'a', -12, std::string_view("z"));
+    if (line != "a--12-z")
+    {
+        std::cerr << "Unexpected append_format() output: " << line << "\n";
+        failures++;
+    }
+
+    // A styled argument switches back to the style of the text around it instead of resetting it.
+    ts::PresetHandle cyan = ts::addPreset("cyan", {
+        .prefix = {
+            .text = "> ",
+            .poststyles = {ts::Color(ts::Codes::FOREGROUND_CYAN)}
+        },
+        .suffix = {
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+    ts::RingBufferTarget around(4096);
+    ts::print(around, cyan, "{} then {}", ts::styled("bold", ts::bold), ts::styled("red", ts::fg(ts::Codes::FOREGROUND_RED)));
+    {
+        ts::StyledWriter tracked(around);
+        tracked.setStateTracking(true);
+        tracked.print(cyan, "{}!", ts::styled("tracked", ts::underline));
+    }
+    std::string markup;
+    ts::append_markup(markup, "[green]{} ok[/]", ts::styled(7, ts::bold));
+    if (around.contents() != "\033[0m> \033[36m\033[1mbold\033[22m then \033[31mred\033[36m\033[0m\033[0m\n"
+                             "> \033[36m\033[4mtracked\033[24m!\n\033[0m"
+        || markup != "\033[32m\033[1m7\033[22m ok\033[0m")
+    {
+        std::cerr << "Styled arguments do not switch back to the style around them.\n";
+        failures++;
+    }
+
+#if defined(__cpp_lib_format)
+    // With <format>, the format specification applies to the styled value, and the style to the padding too.
+    const std::string padded = std::format("[{:>4}]", ts::styled(42, ts::bold));
+    if (padded != "[\033[1m  42\033[0m]")
+    {
+        std::cerr << "Unexpected std::format() output of a styled value: " << padded << "\n";
+        failures++;
+    }
+#endif
+
+    ts::print(stats, "printed {} lines in {}ms", 2, 0.25);
+    ts::StyledWriter writer(ts::defaultTarget());
+    writer.print(stats, "written by a {} {}", "StyledWriter", ts::styled("in place", ts::underline));
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/**
+ * format17.cpp -- tests that format strings and markup templates that do not match their arguments throw
+ * when they cannot be checked at compile time (C++17)
+*/
+
+#include <stdexcept>
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+#if defined(__cpp_consteval)
+int main()
+{
+    std::cout << "skipped: format strings are checked at compile time\n";
+    return 0;
+}
+#else
+namespace
+{
+    /**
+     * Whether `call` throws `std::invalid_argument`.
+    */
+    template<typename F>
+    bool throws(F call)
+    {
+        try
+        {
+            call();
+        }
+        catch (const std::invalid_argument &)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+    ts::setColorSupport(ts::ColorSupport::COL16);
+    ts::PresetConfig config;
+    config.prefix.text = "[STATS] ";
+    const ts::PresetHandle stats = ts::addPreset("stats", config);
+    ts::RingBufferTarget target(4096);
+
+    // Matching format strings work as with C++20.
+    std::string line;
+    ts::append_format(line, "{} of {} {{ok}}", 1, 2);
+    ts::print(target, stats, "{} hits", 930u);
+    ts::append_markup(line, " [red]{}[/]", "x");
+    if (line != "1 of 2 {ok} \033[31mx\033[0m" || target.contents().find("[STATS] 930 hits") == std::string::npos)
+    {
+        std::cerr << "Unexpected output \"" << line << "\" of matching format strings.\n";
+        failures++;
+    }
+
+    // Mismatched ones throw before writing anything.
+    const std::size_t written = target.contents().size();
+    const bool all_throw = throws([&] { ts::append_format(line, "{} of {}", 1); })
+        && throws([&] { ts::append_format(line, "{}", 1, 2); })
+        && throws([&] { ts::append_format(line, "{:x}", 1); })
+        && throws([&] { ts::append_format(line, "a } b", 1); })
+        && throws([&] { ts::print(target, stats, "{} {}", 1); })
+        && throws([&] { ts::print(target, "stats", "{}", 1, 2); })
+        && throws([&] { ts::append_markup(line, "[b]{}[/] {}", 1); })
+        && throws([&] { (void)ts::render("[b]x[/]", 1); });
+    if (!all_throw || target.contents().size() != written)
+    {
+        std::cerr << "A mismatched format string did not throw std::invalid_argument.\n";
+        failures++;
+    }
+
+    std::cout << "checked format strings at run time\n";
+    return failures == 0 ? 0 : 1;
+}
+#endif
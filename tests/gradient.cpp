@@ -0,0 +1,98 @@
+/**
+ * gradient.cpp -- tests coloring text along a gradient, interpolated in OKLab and quantized per color support
+*/
+
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+std::size_t countEscapes(const std::string &str)
+{
+    std::size_t count = 0;
+    for (char c : str) count += c == '\033';
+    return count;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    int failures = 0;
+    const ts::Gradient gray{ts::ColRGB(ts::ColorMode::FOREGROUND, 0, 0, 0),
+                            ts::ColRGB(ts::ColorMode::FOREGROUND, 255, 255, 255)};
+    const ts::ColRGB first = gray.at(0, 5), middle = gray.at(2, 5), last = gray.at(4, 5);
+    // Half way in OKLab is a lightness of 0.5, which is far darker than the sRGB average of 128.
+    if (first.r != 0 || last.r != 255 || last.b != 255 || middle.r != middle.g || middle.g != middle.b
+        || middle.r < 95 || middle.r > 105)
+    {
+        std::cerr << "Unexpected gray gradient: " << middle.r << ' ' << middle.g << ' ' << middle.b << '\n';
+        failures++;
+    }
+
+    std::string rendered;
+    ts::append_to(rendered, gray, "abc");
+    const std::string expected = "\033[38;2;0;0;0ma\033[38;2;" + std::to_string(gray.at(1, 3).r) + ';'
+                                 + std::to_string(gray.at(1, 3).r) + ';' + std::to_string(gray.at(1, 3).r)
+                                 + "mb\033[38;2;255;255;255mc\033[39m";
+    if (rendered != expected)
+    {
+        std::cerr << "Unexpected rendering of " << rendered.size() << " bytes.\n";
+        failures++;
+    }
+
+    // Multi-byte characters take one color each and are never split.
+    const ts::Gradient heat{ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 0, 255),
+                            ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 255, 0),
+                            ts::ColRGB(ts::ColorMode::BACKGROUND, 255, 0, 0)};
+    std::string bar;
+    for (int i = 0; i < 40; i++) bar += "█";
+    rendered.clear();
+    ts::append_to(rendered, heat, bar);
+    if (ts::strip_styles(rendered) != bar || countEscapes(rendered) != 41
+        || rendered.compare(rendered.size() - 5, 5, "\033[49m") != 0)
+    {
+        std::cerr << "Unexpected rendering of a bar with " << countEscapes(rendered) << " escapes.\n";
+        failures++;
+    }
+
+    char buffer[32];
+    if (ts::render_to(buffer, sizeof(buffer), heat, bar) != rendered.size()
+        || std::string(buffer, sizeof(buffer)) != rendered.substr(0, sizeof(buffer)))
+    {
+        std::cerr << "Unexpected rendering into a fixed buffer.\n";
+        failures++;
+    }
+
+    // Adjacent characters that quantize to the same color share one sequence.
+    const ts::Gradient reds{ts::Col256(ts::ColorMode::FOREGROUND, 196), ts::Col256(ts::ColorMode::FOREGROUND, 160)};
+    const std::string line(200, '=');
+    for (ts::ColorSupport support : {ts::ColorSupport::COL256, ts::ColorSupport::COL16})
+    {
+        ts::setColorSupport(support);
+        rendered.clear();
+        ts::append_to(rendered, reds, line);
+        const std::size_t escapes = countEscapes(rendered);
+        if (ts::strip_styles(rendered) != line || escapes > (support == ts::ColorSupport::COL16 ? 2 : 3)
+            || rendered.compare(0, support == ts::ColorSupport::COL16 ? 5 : 11,
+                                support == ts::ColorSupport::COL16 ? "\033[31m" : "\033[38;5;196m") != 0)
+        {
+            std::cerr << "Unexpected quantized rendering with " << escapes << " escapes.\n";
+            failures++;
+        }
+    }
+
+    ts::setColorSupport(ts::ColorSupport::NONE);
+    rendered.clear();
+    ts::append_to(rendered, heat, bar);
+    if (rendered != bar)
+    {
+        std::cerr << "Rendering without color support is not plain.\n";
+        failures++;
+    }
+
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::print(heat, bar);
+    std::cout << '\n';
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/**
+ * inline.cpp -- tests styling values in place with style expressions
+*/
+
+#include <sstream>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    constexpr auto alert = ts::fg(ts::Codes::FOREGROUND_RED) | ts::bold | ts::bg(ts::Col256(ts::ColorMode::BACKGROUND, 236));
+    const auto highlight = ts::fg(255, 128, 0) | ts::underline;
+
+    int failures = 0;
+    std::ostringstream out;
+    out << ts::styled("failed", alert) << " after " << ts::styled(42, highlight) << " ms";
+    if (out.str() != "\033[31;1;48;5;236mfailed\033[0m after \033[38;2;255;128;0;4m42\033[0m ms")
+    {
+        std::cerr << "Unexpected rendering: " << out.str().size() << " bytes.\n";
+        failures++;
+    }
+
+    ts::setColorSupport(ts::ColorSupport::COL16);
+    out.str("");
+    out << ts::styled("failed", alert) << ' ' << ts::styled(42, highlight);
+    if (out.str() != "\033[31;1;40mfailed\033[0m \033[33;4m42\033[0m")
+    {
+        std::cerr << "Unexpected downgraded rendering: " << out.str().size() << " bytes.\n";
+        failures++;
+    }
+
+    ts::setColorSupport(ts::ColorSupport::NONE);
+    out.str("");
+    out << ts::styled("failed", alert);
+    if (out.str() != "failed")
+    {
+        std::cerr << "Styles were rendered without color support.\n";
+        failures++;
+    }
+
+    ts::SgrState state = alert.state();
+    if (state.attributes != 1 << 1 || state.foreground.col16() != ts::Codes::FOREGROUND_RED || state.background.col256().ID != 236)
+    {
+        std::cerr << "Unexpected state of a style expression.\n";
+        failures++;
+    }
+
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    std::cout << ts::styled("Styled", ts::bold | ts::fg(ts::Codes::FOREGROUND_CYAN)) << " in place.\n";
+    ts::print(ts::italic | ts::fg(208), "Printed with a style expression.");
+    return failures == 0 ? 0 : 1;
+}
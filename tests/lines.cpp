@@ -0,0 +1,109 @@
+/**
+ * lines.cpp -- tests printing many lines that share a preset with print_lines(), and gathered writes to a pipe
+*/
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    ts::PresetHandle row = ts::addPreset("row", {
+        .prefix = {
+            .text = "| ",
+            .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 244))}
+        },
+        .suffix = {
+            .text = " |"
+        }
+    });
+
+    std::vector<std::string> lines;
+    for (int i = 0; i < 2000; i++)
+    {
+        lines.push_back(i % 7 == 0 ? "" : "row " + std::to_string(i));
+    }
+
+    ts::RingBufferTarget expected_target(1 << 20), batched_target(1 << 20);
+    for (const std::string &line : lines)
+    {
+        ts::print(expected_target, row, line);
+    }
+    const std::string expected = expected_target.contents();
+    ts::print_lines(batched_target, row, lines);
+
+    int failures = 0;
+    if (batched_target.contents() != expected)
+    {
+        std::cerr << "print_lines() differs from printing each line.\n";
+        failures++;
+    }
+
+    // Temporaries are copied, views are gathered.
+    batched_target.clear();
+    const std::vector<int> numbers = {1, 2, 3};
+    struct Numbers
+    {
+        std::vector<int>::const_iterator it;
+        std::string operator*() const { return std::to_string(*it); }
+        Numbers &operator++() { ++it; return *this; }
+        bool operator!=(const Numbers &other) const { return it != other.it; }
+        bool operator==(const Numbers &other) const { return it == other.it; }
+    };
+    ts::print_lines(batched_target, "row", Numbers{numbers.begin()}, Numbers{numbers.end()});
+    const std::string_view views[] = {"1", "2", "3"};
+    ts::print_lines(batched_target, "row", views);
+    const std::string once = ts::parse(ts::presets["row"], ts::ParseMode::PREFIX) + "1"
+                             + ts::parse(ts::presets["row"], ts::ParseMode::SUFFIX);
+    if (batched_target.contents().size() != 6 * once.size() || batched_target.contents().compare(0, once.size(), once) != 0)
+    {
+        std::cerr << "Unexpected output for temporaries or views.\n";
+        failures++;
+    }
+
+#if !defined(_WIN32)
+    // Through a pipe, the lines take more than IOV_MAX buffers and several partial writes.
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        std::cerr << "Could not create a pipe.\n";
+        return 1;
+    }
+    std::string received;
+    std::thread reader([&] {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            received.append(buffer, static_cast<std::size_t>(n));
+        }
+    });
+    // A line larger than the pipe is gathered without copying and written in several parts.
+    const std::string payload(256 * 1024, 'x');
+    {
+        ts::FdTarget pipe_target(fds[1]);
+        ts::print_lines(pipe_target, row, lines.begin(), lines.end());
+        ts::print(pipe_target, row, payload);
+        close(fds[1]);
+    }
+    reader.join();
+    close(fds[0]);
+    const std::string large = ts::getCompiledPreset(row).prefix + payload + ts::getCompiledPreset(row).suffix;
+    if (received != expected + large)
+    {
+        std::cerr << "The pipe received " << received.size() << " of " << expected.size() + large.size() << " bytes.\n";
+        failures++;
+    }
+#endif
+
+    ts::print_lines("row", views);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+/**
+ * link.cpp -- tests that the header can be included from several translation units of one program,
+ * which share a single preset registry, color support and default target (see link_other.cpp)
+*/
+
+#include <sstream>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+ts::PresetHandle addOtherPreset();
+ts::OutputTarget *otherDefaultTarget();
+std::string renderInOther(ts::PresetHandle preset, std::string_view text);
+
+int main()
+{
+    int failures = 0;
+    ts::setColorSupport(ts::ColorSupport::COL256);
+
+    ts::PresetConfig config;
+    config.prefix.text = "[MAIN] ";
+    config.prefix.prestyles = {ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 255, 0, 0))};
+    const ts::PresetHandle main_preset = ts::addPreset("main", config);
+    const ts::PresetHandle other_preset = addOtherPreset();
+
+    if (ts::getPresetHandle("other").index != other_preset.index
+        || renderInOther(main_preset, "x") != ts::getCompiledPreset(main_preset).prefix + "x" + ts::getCompiledPreset(main_preset).suffix
+        || ts::getCompiledPreset(main_preset).prefix.find("38;5;196") == std::string::npos)
+    {
+        std::cerr << "Presets are not shared between translation units.\n";
+        failures++;
+    }
+    if (otherDefaultTarget() != &ts::defaultTarget())
+    {
+        std::cerr << "The default target is not shared between translation units.\n";
+        failures++;
+    }
+
+    std::cout << "linked two translation units\n";
+    return failures == 0 ? 0 : 1;
+}
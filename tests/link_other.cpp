@@ -0,0 +1,28 @@
+/**
+ * link_other.cpp -- the second translation unit of link.cpp
+*/
+
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+ts::PresetHandle addOtherPreset()
+{
+    ts::PresetConfig config;
+    config.prefix.text = "[OTHER] ";
+    return ts::addPreset("other", config);
+}
+
+ts::OutputTarget *otherDefaultTarget()
+{
+    return &ts::defaultTarget();
+}
+
+/**
+ * Renders a line with a preset registered in the other translation unit, with the color support set there.
+*/
+std::string renderInOther(ts::PresetHandle preset, std::string_view text)
+{
+    const ts::CompiledPreset &compiled = ts::getCompiledPreset(preset);
+    return compiled.prefix + std::string(text) + compiled.suffix;
+}
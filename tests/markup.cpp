@@ -0,0 +1,91 @@
+/**
+ * markup.cpp -- tests rendering markup templates and reusing their compiled form
+*/
+
+#include <set>
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    int failures = 0;
+    const std::pair<std::string, std::string> cases[] = {
+        {ts::render("plain"), "plain"},
+        {ts::render("[b red]ERROR[/] took [cyan]{}ms[/]", 42), "\033[1;31mERROR\033[0m took \033[36m42ms\033[0m"},
+        {ts::render("[bold][italic]x[/]y[/]z"), "\033[1;3mx\033[23my\033[0mz"},
+        {ts::render("[white on color(17)]bar[/]"), "\033[37;48;5;17mbar\033[0m"},
+        {ts::render("[#ff8800]{} {}[/]", "orange", 1.5), "\033[38;2;255;136;0morange 1.5\033[0m"},
+        {ts::render("[on #000000 u]x"), "\033[4;48;2;0;0;0mx\033[0m"},
+        {ts::render("[INFO] [[b]] {{}} [color(300)]"), "[INFO] [b] {} [color(300)]"},
+        {ts::render("[red][/][/]{}", true), "true"},
+    };
+    for (const auto &c : cases)
+    {
+        if (c.first != c.second)
+        {
+            std::cerr << "Unexpected rendering of " << c.first.size() << " bytes, expected " << c.second.size() << ".\n";
+            failures++;
+        }
+    }
+
+    // A template compiled once keeps rendering new arguments, and follows changes of color support.
+    std::string line;
+    for (int i = 0; i < 3; i++)
+    {
+        line.clear();
+        ts::append_markup(line, "[green]{}[/] of {}", i, 3);
+        if (line != "\033[32m" + std::to_string(i) + "\033[0m of 3")
+        {
+            std::cerr << "Unexpected rendering " << i << " of a cached template.\n";
+            failures++;
+        }
+    }
+    ts::setColorSupport(ts::ColorSupport::COL16);
+    if (ts::render("[#ff0000]x[/]") != "\033[31mx\033[0m")
+    {
+        std::cerr << "Colors are not downgraded.\n";
+        failures++;
+    }
+    ts::setColorSupport(ts::ColorSupport::NONE);
+    if (ts::render("[b red]ERROR[/] took {}ms", 7) != "ERROR took 7ms")
+    {
+        std::cerr << "Escape sequences without color support.\n";
+        failures++;
+    }
+
+    // Different strings at the same address are compiled again.
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    char buffer[16] = "[red]a[/]";
+    const std::string first = ts::detail::compiledMarkup(buffer).bytes;
+    std::memcpy(buffer, "[blue]a[/]", 11);
+    const std::string second = ts::detail::compiledMarkup(buffer).bytes;
+    if (first != "\033[31ma\033[0m" || second != "\033[34ma\033[0m")
+    {
+        std::cerr << "A reused address keeps its compiled template.\n";
+        failures++;
+    }
+
+    // Templates built at run time reuse a bounded number of slots, and the template in use stays compiled.
+    const ts::detail::CompiledMarkup *hot = &ts::detail::compiledMarkup("[b]{}[/]");
+    std::set<const ts::detail::CompiledMarkup *> slots;
+    bool hot_kept = true;
+    for (int i = 0; i < 10000; i++)
+    {
+        const std::string dynamic = "[color(" + std::to_string(i % 256) + ")]" + std::to_string(i) + "[/]";
+        const ts::detail::CompiledMarkup &compiled = ts::detail::compiledMarkup(dynamic);
+        slots.insert(&compiled);
+        hot_kept = hot_kept && compiled.source == dynamic && &ts::detail::compiledMarkup("[b]{}[/]") == hot;
+    }
+    if (slots.size() >= ts::detail::markup_cache_size || !hot_kept)
+    {
+        std::cerr << "10000 run-time templates took " << slots.size() << " cache slots.\n";
+        failures++;
+    }
+
+    ts::print_markup("[b green]PASS[/] markup rendered in [cyan]{}[/] cases\n", std::size(cases));
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/**
+ * merge.cpp -- compares the size of presets rendered with and without merged escape sequences
+*/
+
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * Joins adjacent escape sequences, which is what merging should amount to.
+*/
+std::string join(std::string str)
+{
+    for (std::size_t pos = str.find("m\033["); pos != std::string::npos; pos = str.find("m\033[", pos))
+    {
+        str.replace(pos, 3, ";");
+    }
+    return str;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    ts::PresetConfig presets[] = {
+        {
+            .prefix = {
+                .text = "[ERROR] ",
+                .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_RED)},
+                .poststyles = {ts::Color(ts::Codes::BRIGHT_RESET)}
+            }
+        },
+        {
+            .prefix = {
+                .text = "[MIXED] ",
+                .prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 28)),
+                              ts::Color(ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 0, 95))},
+                .prestyle16 = {ts::Codes::BRIGHT, ts::Codes::UNDERLINE},
+                .prestlye256 = {ts::Col256(ts::ColorMode::BACKGROUND, 17)}
+            },
+            .suffix = {
+                .text = " [END]",
+                .prestyles = {ts::Color(ts::Codes::RESTORE), ts::Color(ts::Codes::DIM)}
+            }
+        },
+        {
+            .prefix = {
+                .prestyles = {ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 255, 128, 0))},
+                .poststyles = {ts::Color(ts::Codes::ITALIC)}
+            }
+        },
+    };
+
+    int failures = 0;
+    for (std::size_t i = 0; i < std::size(presets); i++)
+    {
+        ts::PresetConfig merged_preset = presets[i];
+        merged_preset.config.merge_sequences = true;
+        const ts::CompiledPreset &plain = ts::getCompiledPreset(ts::addPreset("plain" + std::to_string(i), presets[i]));
+        const ts::CompiledPreset &merged = ts::getCompiledPreset(ts::addPreset("merged" + std::to_string(i), merged_preset));
+
+        const std::size_t plain_size = plain.prefix.size() + plain.suffix.size();
+        const std::size_t merged_size = merged.prefix.size() + merged.suffix.size();
+        std::cout << "preset " << i << ": " << plain_size << " bytes, merged: " << merged_size << " bytes\n";
+        if (join(plain.prefix) != merged.prefix || join(plain.suffix) != merged.suffix || merged_size >= plain_size)
+        {
+            std::cerr << "Merged preset " << i << " does not match.\n";
+            failures++;
+        }
+    }
+
+    if (ts::getCompiledPreset(ts::getPresetHandle("merged1")).prefix != "\033[1;4;48;5;17;0;38;5;28;48;2;0;0;95m[MIXED] ")
+    {
+        std::cerr << "Unexpected merged prefix.\n";
+        failures++;
+    }
+
+    ts::print("merged1", "This line is styled with merged escape sequences.");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/**
+ * registry.cpp -- tests that recompiling presets frees what it replaces, while other threads keep printing
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+namespace
+{
+    std::atomic<std::size_t> live_bytes{0};
+
+    /** Allocations carry their size in front, so that deallocation can subtract it. */
+    constexpr std::size_t header = alignof(std::max_align_t);
+
+    /**
+     * An output target that discards everything.
+    */
+    struct NullTarget : ts::OutputTarget
+    {
+        void write(std::string_view) override {}
+    };
+}
+
+void *operator new(std::size_t size)
+{
+    char *p = static_cast<char *>(std::malloc(size + header));
+    if (!p) throw std::bad_alloc();
+    *reinterpret_cast<std::size_t *>(p) = size;
+    live_bytes.fetch_add(size, std::memory_order_relaxed);
+    return p + header;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (!p) return;
+    char *block = static_cast<char *>(p) - header;
+    live_bytes.fetch_sub(*reinterpret_cast<std::size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+int main()
+{
+    int failures = 0;
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    for (int i = 0; i < 50; i++)
+    {
+        ts::addPreset("preset" + std::to_string(i), {
+            .prefix = {
+                .text = "[" + std::to_string(i) + "] ",
+                .prestyles = {ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, i, 100, 200))},
+                .poststyles = {ts::Color(ts::Codes::RESTORE)}
+            }
+        });
+    }
+
+    // Readers print through handles and names while the presets are recompiled.
+    NullTarget target;
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++)
+    {
+        readers.emplace_back([&target, &stop, t] {
+            const ts::PresetHandle handle = ts::getPresetHandle("preset" + std::to_string(t));
+            for (std::size_t i = 0; !stop.load(std::memory_order_relaxed); i++)
+            {
+                ts::print(target, handle, "line");
+                ts::style(ts::getPresetHandle("preset7"), target) << i;
+            }
+        });
+    }
+
+    // A thread that read once and went idle keeps only the snapshot it read through.
+    std::atomic<bool> idle_read{false};
+    std::thread idle([&target, &stop, &idle_read] {
+        ts::print(target, "preset3", "once");
+        idle_read = true;
+        while (!stop.load(std::memory_order_relaxed)) std::this_thread::yield();
+    });
+    while (!idle_read.load()) std::this_thread::yield();
+
+    ts::recompilePresets();
+    const std::size_t before = live_bytes.load();
+    for (int i = 0; i < 2000; i++)
+    {
+        ts::recompilePresets();
+        ts::recompilePreset("preset" + std::to_string(i % 50));
+        ts::setColorSupport(i % 2 ? ts::ColorSupport::COL256 : ts::ColorSupport::COLRGB);
+        if (i % 100 == 0)
+        {
+            // Threads that exit release their slots to the next ones.
+            std::thread([&target] { ts::print(target, "preset4", "short-lived"); }).join();
+        }
+    }
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+    stop = true;
+    for (std::thread &reader : readers) reader.join();
+    idle.join();
+    ts::recompilePresets();
+    const std::size_t after = live_bytes.load();
+
+    // Each recompilation replaces about 10 KiB; keeping them would take tens of MiB.
+    if (after > before + (64u << 10))
+    {
+        std::cerr << "Recompiling presets grew memory from " << before << " to " << after << " bytes.\n";
+        failures++;
+    }
+
+    std::cout << "recompiled 50 presets 2000 times, " << after / 1024 << " KiB live\n";
+    return failures == 0 ? 0 : 1;
+}
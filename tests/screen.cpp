@@ -0,0 +1,212 @@
+/**
+ * screen.cpp -- tests that flushing a screen buffer only writes what changed and leaves the terminal showing every cell
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * A terminal that understands what `ScreenBuffer` writes: SGR sequences, absolute and forward cursor movement,
+ * clearing the screen, carriage returns and new lines.
+*/
+struct Terminal
+{
+    std::size_t width, height;
+    std::vector<ts::Cell> cells;
+    ts::SgrState state;
+    std::size_t x = 0, y = 0;
+
+    Terminal(std::size_t width, std::size_t height) : width(width), height(height), cells(width * height) {}
+
+    void feed(const std::string &output)
+    {
+        for (std::size_t i = 0; i < output.size();)
+        {
+            if (output[i] == '\r')
+            {
+                x = 0;
+                i++;
+            }
+            else if (output[i] == '\n')
+            {
+                y++;
+                i++;
+            }
+            else if (output[i] == '\033')
+            {
+                std::vector<int> params;
+                int value = 0;
+                for (i += 2; std::isdigit(static_cast<unsigned char>(output[i])) || output[i] == ';'; i++)
+                {
+                    if (output[i] == ';')
+                    {
+                        params.push_back(value);
+                        value = 0;
+                    }
+                    else
+                    {
+                        value = value * 10 + (output[i] - '0');
+                    }
+                }
+                params.push_back(value);
+                control(output[i++], params);
+            }
+            else
+            {
+                std::size_t length = 1;
+                while (i + length < output.size() && (static_cast<unsigned char>(output[i + length]) & 0xC0) == 0x80) length++;
+                ts::Cell &cell = cells.at(y * width + std::min(x, width - 1));
+                std::memset(cell.glyph, 0, sizeof(cell.glyph));
+                std::memcpy(cell.glyph, output.data() + i, length);
+                cell.setStyle(state);
+                x++;
+                i += length;
+            }
+        }
+    }
+
+    void control(char final, const std::vector<int> &params)
+    {
+        if (final == 'H')
+        {
+            y = static_cast<std::size_t>(params[0] - 1);
+            x = static_cast<std::size_t>(params[1] - 1);
+        }
+        else if (final == 'C')
+        {
+            x = std::min(x + static_cast<std::size_t>(std::max(params[0], 1)), width - 1);
+        }
+        else if (final == 'J')
+        {
+            std::fill(cells.begin(), cells.end(), ts::Cell());
+        }
+        else if (final == 'm')
+        {
+            for (std::size_t p = 0; p < params.size(); p++)
+            {
+                if (params[p] == 38 || params[p] == 48)
+                {
+                    ts::ColorMode mode = static_cast<ts::ColorMode>(params[p]);
+                    if (params[p + 1] == 5)
+                    {
+                        state.apply(ts::Col256(mode, params[p + 2]));
+                        p += 2;
+                    }
+                    else
+                    {
+                        state.apply(ts::ColRGB(mode, params[p + 2], params[p + 3], params[p + 4]));
+                        p += 4;
+                    }
+                }
+                else
+                {
+                    state.apply(static_cast<ts::Codes>(params[p]));
+                }
+            }
+        }
+    }
+
+    bool shows(const ts::ScreenBuffer &screen) const
+    {
+        for (std::size_t row = 0; row < height; row++)
+        {
+            for (std::size_t col = 0; col < width; col++)
+            {
+                if (cells[row * width + col] != screen.at(col, row)) return false;
+            }
+        }
+        return true;
+    }
+};
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    int failures = 0;
+    ts::SgrState red, header;
+    red.apply(ts::Codes::FOREGROUND_RED);
+    header.apply(std::vector<ts::Color>{ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Col256(ts::ColorMode::BACKGROUND, 17))});
+
+    ts::ScreenBuffer screen(12, 4);
+    Terminal terminal(12, 4);
+    std::string output;
+    screen.put(0, 0, " Dashboard  ", header);
+    screen.put(0, 2, "cpu: 42%");
+    screen.put(5, 2, "42", red);
+    screen.render(output);
+    terminal.feed(output);
+    if (!terminal.shows(screen) || terminal.state != ts::SgrState())
+    {
+        std::cerr << "The first frame is not shown.\n";
+        failures++;
+    }
+
+    output.clear();
+    if (screen.render(output) != 0)
+    {
+        std::cerr << "An unchanged frame writes " << output.size() << " bytes.\n";
+        failures++;
+    }
+
+    screen.put(5, 2, "57", red);
+    screen.put(9, 0, "✓", header);
+    output.clear();
+    screen.render(output);
+    terminal.feed(output);
+    if (output != "\033[1;10H\033[1;48;5;17m✓\033[3;6H\033[0;31m57\033[0m" || !terminal.shows(screen))
+    {
+        std::cerr << "Unexpected update of " << output.size() << " bytes.\n";
+        failures++;
+    }
+
+    // Short gaps in the same style are rewritten rather than skipped with a cursor movement.
+    screen.put(0, 3, "a b");
+    output.clear();
+    screen.render(output);
+    terminal.feed(output);
+    if (output != "\033[4;1Ha b" || !terminal.shows(screen))
+    {
+        std::cerr << "Unexpected update of " << output.size() << " bytes across a gap.\n";
+        failures++;
+    }
+
+    // Random frames of a larger screen.
+    std::mt19937 rng(3);
+    const char *glyphs[] = {"x", "y", " ", "█", "é"};
+    ts::ScreenBuffer big(40, 10);
+    Terminal big_terminal(40, 10);
+    for (int frame = 0; frame < 50; frame++)
+    {
+        const int changes = frame % 10 == 0 ? 400 : static_cast<int>(rng() % 30);
+        for (int i = 0; i < changes; i++)
+        {
+            ts::SgrState style;
+            if (rng() % 2) style.apply(static_cast<ts::Codes>(31 + rng() % 7));
+            if (rng() % 3 == 0) style.apply(ts::ColRGB(ts::ColorMode::BACKGROUND, 0, 0, static_cast<int>(rng() % 4)));
+            if (rng() % 4 == 0) style.apply(ts::Codes::UNDERLINE);
+            big.put(rng() % 40, rng() % 10, glyphs[rng() % std::size(glyphs)], style);
+        }
+        if (frame == 25) big.invalidate();
+        output.clear();
+        big.render(output);
+        big_terminal.feed(output);
+        if (!big_terminal.shows(big) || big_terminal.state != ts::SgrState())
+        {
+            std::cerr << "Frame " << frame << " is not shown.\n";
+            failures++;
+        }
+    }
+
+    big.resize(20, 5);
+    if (big.width() != 20 || big.height() != 5 || big.put(18, 4, "abc") != 20)
+    {
+        std::cerr << "Unexpected size after resizing.\n";
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/**
+ * state.cpp -- tests that tracking the terminal state shortens the output without changing what is displayed
+*/
+
+#include <string>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * Replays `output` like a terminal would and records the state every character is displayed in.
+ * New lines only record the background, as that is all they show.
+*/
+std::vector<std::pair<char, ts::SgrState>> replay(const std::string &output)
+{
+    std::vector<std::pair<char, ts::SgrState>> cells;
+    ts::SgrState state;
+    for (std::size_t i = 0; i < output.size(); i++)
+    {
+        if (output[i] != '\033')
+        {
+            ts::SgrState shown = state;
+            if (output[i] == '\n')
+            {
+                shown.attributes = 0;
+                shown.foreground = ts::Color(ts::Codes::FOREGROUND_RESET);
+            }
+            cells.emplace_back(output[i], shown);
+            continue;
+        }
+        std::vector<int> params;
+        int value = 0;
+        for (i += 2; output[i] != 'm'; i++)
+        {
+            if (output[i] == ';')
+            {
+                params.push_back(value);
+                value = 0;
+            }
+            else
+            {
+                value = value * 10 + (output[i] - '0');
+            }
+        }
+        params.push_back(value);
+        for (std::size_t p = 0; p < params.size(); p++)
+        {
+            if (params[p] == 38 || params[p] == 48)
+            {
+                ts::ColorMode mode = static_cast<ts::ColorMode>(params[p]);
+                if (params[p + 1] == 5)
+                {
+                    state.apply(ts::Col256(mode, params[p + 2]));
+                    p += 2;
+                }
+                else
+                {
+                    state.apply(ts::ColRGB(mode, params[p + 2], params[p + 3], params[p + 4]));
+                    p += 4;
+                }
+            }
+            else
+            {
+                state.apply(static_cast<ts::Codes>(params[p]));
+            }
+        }
+    }
+    return cells;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    ts::PresetHandle info = ts::addPreset("info", {
+        .prefix = {
+            .text = "[INFO] ",
+            .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Codes::FOREGROUND_GREEN)},
+            .poststyles = {ts::Color(ts::Codes::RESTORE)}
+        }
+    });
+    ts::PresetHandle warn = ts::addPreset("warn", {
+        .prefix = {
+            .text = "[WARN] ",
+            .prestyles = {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, 214))},
+            .poststyles = {ts::Color(ts::Codes::BRIGHT_RESET)}
+        }
+    });
+    ts::PresetHandle trace = ts::addPreset("trace", {
+        .prefix = {
+            .prestyles = {ts::Color(ts::Codes::DIM), ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 120, 120, 120))}
+        }
+    });
+    ts::PresetHandle banner = ts::addPreset("banner", {
+        .prefix = {
+            .prestyles = {ts::Color(ts::Codes::REVERSE), ts::Color(ts::Codes::BACKGROUND_BLUE)}
+        }
+    });
+
+    const std::pair<ts::PresetHandle, const char *> lines[] = {
+        {banner, "service starting"},
+        {info, "listening on port 8080"},
+        {info, "connected to database"},
+        {trace, "pool size 16"},
+        {trace, "pool size 32"},
+        {trace, "pool size 64"},
+        {warn, "cache is cold"},
+        {warn, "slow query"},
+        {info, "ready"},
+        {banner, "service ready"},
+    };
+
+    ts::RingBufferTarget plain_target(1 << 16), tracked_target(1 << 16);
+    {
+        ts::StyledWriter plain(plain_target);
+        ts::StyledWriter tracked(tracked_target);
+        tracked.setStateTracking(true);
+        for (const auto &line : lines)
+        {
+            plain.print(line.first, line.second);
+            tracked.print(line.first, line.second);
+        }
+        plain.print(ts::static_style<ts::Codes::UNDERLINE>, "done");
+        tracked.print(ts::static_style<ts::Codes::UNDERLINE>, "done");
+    }
+
+    int failures = 0;
+    const std::string plain_output = plain_target.contents(), tracked_output = tracked_target.contents();
+    if (!(replay(plain_output) == replay(tracked_output)))
+    {
+        std::cerr << "Tracked output is displayed differently.\n";
+        failures++;
+    }
+    if (tracked_output.size() >= plain_output.size())
+    {
+        std::cerr << "Tracked output is not shorter.\n";
+        failures++;
+    }
+    std::cout << "untracked: " << plain_output.size() << " bytes, tracked: " << tracked_output.size() << " bytes\n";
+
+    ts::SgrState bold_red, bold_green, red, green;
+    bold_red.apply(std::vector<ts::Codes>{ts::Codes::BRIGHT, ts::Codes::FOREGROUND_RED});
+    red.apply(ts::Codes::FOREGROUND_RED);
+    bold_green.apply(std::vector<ts::Codes>{ts::Codes::BRIGHT, ts::Codes::FOREGROUND_GREEN});
+    green.apply(ts::Codes::FOREGROUND_GREEN);
+    const std::pair<std::string, std::string> transitions[] = {
+        {ts::transition(bold_red, bold_red), ""},
+        {ts::transition(bold_red, bold_green), "\033[32m"},
+        {ts::transition(bold_red, red), "\033[22m"},
+        {ts::transition(bold_red, green), "\033[0;32m"},
+        {ts::transition(bold_red, ts::SgrState()), "\033[0m"},
+        {ts::transition(ts::SgrState(), bold_red), "\033[1;31m"},
+    };
+    for (const auto &t : transitions)
+    {
+        if (t.first != t.second)
+        {
+            std::cerr << "Unexpected transition of " << t.first.size() << " bytes.\n";
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/**
+ * statusbar.cpp -- tests rendering a status bar of differently styled fields in one pass
+*/
+
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    const ts::Color bold(ts::Codes::BRIGHT);
+    const ts::Color green(ts::Codes::FOREGROUND_GREEN);
+    const ts::Color bar(ts::Col256(ts::ColorMode::BACKGROUND, 236));
+
+    ts::StyledText status;
+    status.append(" NORMAL ", {bold, ts::Color(ts::Codes::REVERSE)})
+        .append(" main.cpp ", {bar})
+        .append("[+]", {bar, green})
+        .append(" ", {bar})
+        .append("utf-8", {bar})
+        .append(" | ")
+        .append("12:34", {bold, green});
+
+    int failures = 0;
+    if (status.text() != " NORMAL  main.cpp [+] utf-8 | 12:34" || status.spans().size() != 6)
+    {
+        std::cerr << "Unexpected text or spans.\n";
+        failures++;
+    }
+
+    std::string rendered;
+    ts::append_to(rendered, status);
+    const std::string expected = "\033[1;7m NORMAL \033[0;48;5;236m main.cpp \033[32m[+]\033[39m utf-8"
+                                 "\033[0m | \033[1;32m12:34\033[0m";
+    if (rendered != expected)
+    {
+        std::cerr << "Unexpected rendering of " << rendered.size() << " bytes.\n";
+        failures++;
+    }
+
+    char buffer[16];
+    if (ts::render_to(buffer, sizeof(buffer), status) != expected.size() || std::string(buffer, 16) != expected.substr(0, 16))
+    {
+        std::cerr << "Unexpected rendering into a fixed buffer.\n";
+        failures++;
+    }
+
+    ts::print(status);
+    std::cout << '\n';
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/**
+ * strip.cpp -- tests removing SGR sequences from styled output and measuring its visible width
+*/
+
+#include <random>
+#include <string>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+/**
+ * Strips SGR sequences one byte at a time, which is what the vectorized scan should amount to.
+*/
+std::string reference(const std::string &str)
+{
+    std::string result;
+    for (std::size_t i = 0; i < str.size(); i++)
+    {
+        if (str[i] == '\033' && i + 2 < str.size() && str[i + 1] == '[')
+        {
+            std::size_t end = i + 2;
+            while (end < str.size() && ((str[end] >= '0' && str[end] <= '9') || str[end] == ';' || str[end] == ':')) end++;
+            if (end < str.size() && str[end] == 'm')
+            {
+                i = end;
+                continue;
+            }
+        }
+        result += str[i];
+    }
+    return result;
+}
+
+int main()
+{
+    ts::setColorSupport(ts::ColorSupport::COLRGB);
+
+    int failures = 0;
+    const std::pair<std::string, std::string> cases[] = {
+        {"", ""},
+        {"plain", "plain"},
+        {"\033[1;31mred\033[0m", "red"},
+        {"\033[mreset\033[38:2:1:2:3m", "reset"},
+        {"\033[2Jclear", "\033[2Jclear"},
+        {"lone \033 escape", "lone \033 escape"},
+        {"cut off \033[31", "cut off \033[31"},
+        {"\033\033[1mnested", "\033nested"},
+    };
+    for (const auto &c : cases)
+    {
+        std::string in_place = c.first;
+        in_place.resize(ts::strip_styles(in_place.data(), in_place.size()));
+        if (ts::strip_styles(c.first) != c.second || in_place != c.second)
+        {
+            std::cerr << "Unexpected stripping of " << c.first.size() << " bytes.\n";
+            failures++;
+        }
+    }
+
+    ts::StyledText status;
+    status.append("héllo", {ts::Color(ts::Codes::BRIGHT), ts::Color(ts::ColRGB(ts::ColorMode::FOREGROUND, 255, 128, 0))})
+        .append(" ")
+        .append("wörld", {ts::Color(ts::Col256(ts::ColorMode::BACKGROUND, 17))});
+    std::string rendered;
+    ts::append_to(rendered, status);
+    if (ts::strip_styles(rendered) != status.text() || ts::visible_width(rendered) != 11)
+    {
+        std::cerr << "Unexpected width " << ts::visible_width(rendered) << " of rendered text.\n";
+        failures++;
+    }
+
+    // Random inputs of every length cross the 16 and 32 byte chunk boundaries at every offset.
+    std::mt19937 rng(7);
+    const char alphabet[] = {'a', 'b', '\033', '[', '1', ';', 'm', '\n', '\xC3', '\xA9'};
+    for (std::size_t length = 0; length < 300; length++)
+    {
+        std::string str;
+        for (std::size_t i = 0; i < length; i++)
+        {
+            str += rng() % 4 == 0 ? alphabet[rng() % std::size(alphabet)] : 'x';
+        }
+        const std::string expected = reference(str);
+        std::string in_place = str;
+        in_place.resize(ts::strip_styles(in_place.data(), in_place.size()));
+        std::size_t width = 0;
+        for (char c : expected) width += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+        if (ts::strip_styles(str) != expected || in_place != expected || ts::visible_width(str) != width)
+        {
+            std::cerr << "Stripping a random string of " << length << " bytes does not match.\n";
+            failures++;
+        }
+    }
+
+    std::cout << ts::strip_styles(rendered) << '\n';
+    return failures == 0 ? 0 : 1;
+}
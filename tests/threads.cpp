@@ -0,0 +1,70 @@
+/**
+ * threads.cpp -- stress tests printing from several threads while presets are being registered
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../include/termstyle.hpp"
+
+namespace ts = termstyle;
+
+int main()
+{
+    const int thread_count = 8;
+    const int lines_per_thread = 2000;
+    const int plugin_count = 200;
+
+    ts::PresetConfig base_preset;
+    base_preset.prefix.prestyles = {ts::Color(ts::Codes::DIM)};
+    base_preset.prefix.text = "[worker] ";
+    ts::PresetHandle base = ts::addPreset("worker", base_preset);
+
+    std::atomic<int> registered{0};
+    std::atomic<int> failures{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thread_count; t++)
+    {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < lines_per_thread; i++)
+            {
+                ts::print(base, "thread " + std::to_string(t) + " line " + std::to_string(i));
+                int available = registered.load(std::memory_order_acquire);
+                if (available == 0) continue;
+                try
+                {
+                    ts::print("plugin" + std::to_string(i % available), "registered by the plugin thread");
+                }
+                catch (const PresetNotFound &)
+                {
+                    failures++;
+                }
+            }
+        });
+    }
+
+    std::thread plugins([&] {
+        for (int i = 0; i < plugin_count; i++)
+        {
+            ts::PresetConfig plugin_preset;
+            plugin_preset.prefix.prestyles = {ts::Color(ts::Col256(ts::ColorMode::FOREGROUND, i))};
+            plugin_preset.prefix.text = "[plugin " + std::to_string(i) + "] ";
+            ts::addPreset("plugin" + std::to_string(i), plugin_preset);
+            registered.store(i + 1, std::memory_order_release);
+        }
+    });
+
+    plugins.join();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " lookups of registered presets failed.\n";
+        return 1;
+    }
+    return 0;
+}